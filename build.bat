@@ -1,28 +1,109 @@
 @echo off
 setlocal
 
+REM Optimized, with OpenMP so the analytics use every core
+set CXXFLAGS=-std=c++17 -O2 -fopenmp
+
 REM Create build directory if it doesn't exist
 if not exist "build" mkdir build
 
 echo Compiling source files...
-g++ -c "cpp files/main.cpp" -I"header files" -o build/main.o
-g++ -c "cpp files/adjacency_matrix.cpp" -I"header files" -o build/adjacency_matrix.o
-g++ -c "cpp files/connection_manager.cpp" -I"header files" -o build/connection_manager.o
-g++ -c "cpp files/login_manager.cpp" -I"header files" -o build/login_manager.o
-g++ -c "cpp files/graph_visualizer.cpp" -I"header files" -o build/graph_visualizer.o
-g++ -c "cpp files/connection_handler.cpp" -I"header files" -o build/connection_handler.o
-g++ -c "cpp files/print_utilities.cpp" -I"header files" -o build/print_utilities.o
+g++ %CXXFLAGS% -c "cpp files/main.cpp" -I"header files" -o build/main.o
+g++ %CXXFLAGS% -c "cpp files/adjacency_matrix.cpp" -I"header files" -o build/adjacency_matrix.o
+g++ %CXXFLAGS% -c "cpp files/connection_manager.cpp" -I"header files" -o build/connection_manager.o
+g++ %CXXFLAGS% -c "cpp files/login_manager.cpp" -I"header files" -o build/login_manager.o
+g++ %CXXFLAGS% -c "cpp files/graph_visualizer.cpp" -I"header files" -o build/graph_visualizer.o
+g++ %CXXFLAGS% -c "cpp files/connection_handler.cpp" -I"header files" -o build/connection_handler.o
+g++ %CXXFLAGS% -c "cpp files/print_utilities.cpp" -I"header files" -o build/print_utilities.o
+g++ %CXXFLAGS% -c "cpp files/link_predictor.cpp" -I"header files" -o build/link_predictor.o
+g++ %CXXFLAGS% -c "cpp files/minhash_index.cpp" -I"header files" -o build/minhash_index.o
+g++ %CXXFLAGS% -c "cpp files/user_store.cpp" -I"header files" -o build/user_store.o
+g++ %CXXFLAGS% -c "cpp files/socket_server.cpp" -I"header files" -o build/socket_server.o
+g++ %CXXFLAGS% -c "cpp files/analytics_snapshot.cpp" -I"header files" -o build/analytics_snapshot.o
+g++ %CXXFLAGS% -c "cpp files/edge_store.cpp" -I"header files" -o build/edge_store.o
+g++ %CXXFLAGS% -c "cpp files/force_layout.cpp" -I"header files" -o build/force_layout.o
+g++ %CXXFLAGS% -c "cpp files/leaderboard.cpp" -I"header files" -o build/leaderboard.o
+g++ %CXXFLAGS% -c "cpp files/metrics.cpp" -I"header files" -o build/metrics.o
+g++ %CXXFLAGS% -c "cpp files/trace.cpp" -I"header files" -o build/trace.o
+g++ %CXXFLAGS% -c "cpp files/memory_accounting.cpp" -I"header files" -o build/memory_accounting.o
+g++ %CXXFLAGS% -c "cpp files/dense_graph.cpp" -I"header files" -o build/dense_graph.o
+g++ %CXXFLAGS% -c "cpp files/distance_oracle.cpp" -I"header files" -o build/distance_oracle.o
+g++ %CXXFLAGS% -c "cpp files/parse_utilities.cpp" -I"header files" -o build/parse_utilities.o
+g++ %CXXFLAGS% -c "cpp files/benchmark.cpp" -I"header files" -o build/benchmark.o
+g++ %CXXFLAGS% -c "cpp files/replay.cpp" -I"header files" -o build/replay.o
 
 echo Linking...
-g++ build/main.o ^
+g++ %CXXFLAGS% build/main.o ^
     build/adjacency_matrix.o ^
     build/connection_manager.o ^
     build/login_manager.o ^
     build/graph_visualizer.o ^
     build/connection_handler.o ^
     build/print_utilities.o ^
+    build/link_predictor.o ^
+    build/minhash_index.o ^
+    build/user_store.o ^
+    build/socket_server.o ^
+    build/analytics_snapshot.o ^
+    build/edge_store.o ^
+    build/force_layout.o ^
+    build/leaderboard.o ^
+    build/metrics.o ^
+    build/trace.o ^
+    build/memory_accounting.o ^
+    build/dense_graph.o ^
+    build/distance_oracle.o ^
+    build/parse_utilities.o ^
     -o program.exe
 
+echo Linking benchmark...
+g++ %CXXFLAGS% build/benchmark.o ^
+    build/adjacency_matrix.o ^
+    build/connection_manager.o ^
+    build/login_manager.o ^
+    build/graph_visualizer.o ^
+    build/connection_handler.o ^
+    build/print_utilities.o ^
+    build/link_predictor.o ^
+    build/minhash_index.o ^
+    build/user_store.o ^
+    build/socket_server.o ^
+    build/analytics_snapshot.o ^
+    build/edge_store.o ^
+    build/force_layout.o ^
+    build/leaderboard.o ^
+    build/metrics.o ^
+    build/trace.o ^
+    build/memory_accounting.o ^
+    build/dense_graph.o ^
+    build/distance_oracle.o ^
+    build/parse_utilities.o ^
+    -o benchmark.exe
+
+echo Linking replay...
+g++ %CXXFLAGS% build/replay.o ^
+    build/adjacency_matrix.o ^
+    build/connection_manager.o ^
+    build/login_manager.o ^
+    build/graph_visualizer.o ^
+    build/connection_handler.o ^
+    build/print_utilities.o ^
+    build/link_predictor.o ^
+    build/minhash_index.o ^
+    build/user_store.o ^
+    build/socket_server.o ^
+    build/analytics_snapshot.o ^
+    build/edge_store.o ^
+    build/force_layout.o ^
+    build/leaderboard.o ^
+    build/metrics.o ^
+    build/trace.o ^
+    build/memory_accounting.o ^
+    build/dense_graph.o ^
+    build/distance_oracle.o ^
+    build/parse_utilities.o ^
+    -o replay.exe
+
 echo Running program...
 program.exe
 
@@ -1,8 +1,18 @@
 #include "adjacency_matrix.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_accounting.h"
 #include <bits/stdc++.h>
 
 using namespace std;
 
+// Metrics
+static const Metrics::Counter matrix_updates = Metrics::counter("matrix_connection_updates_total", "Connection weights written to the matrix");
+static const Metrics::Counter matrix_bytes_written = Metrics::counter("matrix_bytes_written_total", "Bytes written by matrix saves");
+static const Metrics::Counter matrix_bytes_read = Metrics::counter("matrix_bytes_read_total", "Bytes read by matrix loads");
+static const Metrics::Histogram matrix_save_seconds = Metrics::histogram("matrix_save_seconds", "Matrix saves");
+static const Metrics::Histogram matrix_load_seconds = Metrics::histogram("matrix_load_seconds", "Matrix loads");
+
 // Static Helper Functions
 static mt19937 &getRNG()
 {
@@ -34,6 +44,7 @@ AdjacencyMatrix::~AdjacencyMatrix()
 void AdjacencyMatrix::initializeBaseMatrix(const vector<User *> &users,
                                            const vector<vector<User *>> &communities)
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::AdjacencyMatrix);
     // Check if file exists first
     ifstream check_file(matrix_file_path);
     if (check_file.good())
@@ -78,6 +89,7 @@ void AdjacencyMatrix::initializeBaseMatrix(const vector<User *> &users,
 
 void AdjacencyMatrix::addNewUser(const string &userId)
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::AdjacencyMatrix);
     // Check if user already exists
     if (user_index_map.find(userId) != user_index_map.end())
     {
@@ -100,11 +112,43 @@ void AdjacencyMatrix::addNewUser(const string &userId)
 
     hasChanges = true;
     // Save immediately after adding new user
-    saveToFile();
+    if (!deferredSaves)
+    {
+        saveToFile();
+    }
+}
+
+void AdjacencyMatrix::addNewUsers(const vector<string> &userIds)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::AdjacencyMatrix);
+    size_t old_size = matrix.size();
+    for (const auto &userId : userIds)
+    {
+        if (user_index_map.find(userId) == user_index_map.end())
+        {
+            user_index_map[userId] = user_ids.size();
+            user_ids.push_back(userId);
+        }
+    }
+
+    size_t new_size = user_ids.size();
+    if (new_size == old_size)
+    {
+        return;
+    }
+
+    // Grow existing rows once, then append the new zero rows
+    for (auto &row : matrix)
+    {
+        row.resize(new_size, 0.0);
+    }
+    matrix.resize(new_size, vector<double>(new_size, 0.0));
+
+    hasChanges = true;
 }
 
 void AdjacencyMatrix::updateConnection(const string &user1_id, const string &user2_id,
-                                       const vector<vector<User *>> &communities)
+                                       int community1, int community2, bool save_immediately)
 {
     // Get matrix indices
     auto it1 = user_index_map.find(user1_id);
@@ -122,15 +166,12 @@ void AdjacencyMatrix::updateConnection(const string &user1_id, const string &use
     double weight = getRandomWeight(13.5); // Start with minimum weight
 
     // Base weight if in same community
-    if (areInSameCommunity(user1_id, user2_id, communities))
+    if (community1 == community2)
     {
         weight += getRandomWeight(7.0); // Increase by 7 for same community
     }
 
     // Additional weight based on community structure
-    int community1 = findCommunityIndex(user1_id, communities);
-    int community2 = findCommunityIndex(user2_id, communities);
-
     if (community1 != -1 && community2 != -1)
     {
         if (community1 == community2)
@@ -152,9 +193,13 @@ void AdjacencyMatrix::updateConnection(const string &user1_id, const string &use
     matrix[idx1][idx2] = weight;
     matrix[idx2][idx1] = weight;
     hasChanges = true;
+    matrix_updates.add();
 
     // Save changes immediately after updating weights
-    saveToFile(); // This ensures weights are persisted right away
+    if (save_immediately && !deferredSaves)
+    {
+        saveToFile(); // This ensures weights are persisted right away
+    }
 }
 
 double AdjacencyMatrix::calculateConnectionWeight(User *user1, User *user2,
@@ -163,9 +208,9 @@ double AdjacencyMatrix::calculateConnectionWeight(User *user1, User *user2,
     double weight = 0.0;
 
     // Base similarity checks
-    if (user1->getCategory() == user2->getCategory())
+    if (user1->getCategoryCode() == user2->getCategoryCode())
         weight += getRandomWeight(6.0);
-    if (user1->getBranch() == user2->getBranch())
+    if (user1->getBranchCode() == user2->getBranchCode())
         weight += getRandomWeight(5.0);
 
     // Community based weight
@@ -184,6 +229,8 @@ double AdjacencyMatrix::calculateConnectionWeight(User *user1, User *user2,
 
 void AdjacencyMatrix::saveToFile()
 {
+    Metrics::ScopedTimer timer(matrix_save_seconds);
+    Trace::Span span("matrix save", "io");
     ofstream file(matrix_file_path);
     if (!file.is_open())
     {
@@ -212,12 +259,16 @@ void AdjacencyMatrix::saveToFile()
         file << "\n";
     }
 
+    matrix_bytes_written.add(file.tellp());
     file.close();
     hasChanges = false; // Reset changes flag after saving
 }
 
 void AdjacencyMatrix::loadFromFile()
 {
+    Metrics::ScopedTimer timer(matrix_load_seconds);
+    Trace::Span span("matrix load", "io");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::AdjacencyMatrix);
     ifstream file(matrix_file_path);
     if (!file.is_open())
     {
@@ -230,10 +281,12 @@ void AdjacencyMatrix::loadFromFile()
     user_index_map.clear();
 
     string line;
+    uint64_t bytes_read = 0;
 
     // Read header
     if (getline(file, line))
     {
+        bytes_read += line.size() + 1;
         stringstream ss(line);
         string cell;
         getline(ss, cell, ','); // Skip empty cell
@@ -252,6 +305,7 @@ void AdjacencyMatrix::loadFromFile()
     // Read matrix data
     while (getline(file, line))
     {
+        bytes_read += line.size() + 1;
         stringstream ss(line);
         string cell;
         getline(ss, cell, ','); // Skip row header
@@ -270,6 +324,7 @@ void AdjacencyMatrix::loadFromFile()
         }
     }
 
+    matrix_bytes_read.add(bytes_read);
     file.close();
 }
 
@@ -286,6 +341,21 @@ double AdjacencyMatrix::getConnectionWeight(const string &user1_id, const string
     return matrix[it1->second][it2->second];
 }
 
+const unordered_map<string, int> &AdjacencyMatrix::getUserIndexMap() const
+{
+    return user_index_map;
+}
+
+const vector<vector<double>> &AdjacencyMatrix::getMatrix() const
+{
+    return matrix;
+}
+
+const vector<string> &AdjacencyMatrix::getUserIds() const
+{
+    return user_ids;
+}
+
 void AdjacencyMatrix::removeConnection(const string &user1_id, const string &user2_id)
 {
     auto it1 = user_index_map.find(user1_id);
@@ -295,7 +365,10 @@ void AdjacencyMatrix::removeConnection(const string &user1_id, const string &use
     matrix[it2->second][it1->second] = 0;
 
     hasChanges = true;
-    saveToFile();
+    if (!deferredSaves)
+    {
+        saveToFile();
+    }
 }
 
 void AdjacencyMatrix::printMatrix() const
@@ -352,4 +425,9 @@ void AdjacencyMatrix::forceSave()
     {
         saveToFile();
     }
+}
+
+void AdjacencyMatrix::setDeferredSaves(bool deferred)
+{
+    deferredSaves = deferred;
 }
\ No newline at end of file
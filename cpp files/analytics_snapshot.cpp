@@ -0,0 +1,121 @@
+#include "analytics_snapshot.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+static const char SnapshotMagic[4] = {'S', 'N', 'A', 'P'};
+static const uint32_t SnapshotFormatVersion = 1;
+
+// Static Helper Functions
+template <typename T>
+static void writeValue(ofstream &file, const T &value)
+{
+    file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool readValue(ifstream &file, T &value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template <typename T>
+static void writeArray(ofstream &file, const vector<T> &values)
+{
+    writeValue(file, static_cast<uint32_t>(values.size()));
+    file.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+// Bytes left after the read position, for bounding counts before allocating
+static uint64_t remainingBytes(ifstream &file)
+{
+    streampos position = file.tellg();
+    file.seekg(0, ios::end);
+    streampos end = file.tellg();
+    file.seekg(position);
+    return end > position ? static_cast<uint64_t>(end - position) : 0;
+}
+
+template <typename T>
+static bool readArray(ifstream &file, vector<T> &values)
+{
+    uint32_t count;
+    if (!readValue(file, count) || count > remainingBytes(file) / sizeof(T)) // Reject corrupt sizes before allocating
+        return false;
+    values.resize(count);
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(values.data()), count * sizeof(T)));
+}
+
+bool AnalyticsSnapshot::saveToFile(const string &file_path) const
+{
+    // Write to a temporary file first so a crash never leaves a half-written snapshot
+    string temp_path = file_path + ".tmp";
+    ofstream file(temp_path, ios::binary);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open analytics snapshot for writing." << endl;
+        return false;
+    }
+
+    file.write(SnapshotMagic, sizeof(SnapshotMagic));
+    writeValue(file, SnapshotFormatVersion);
+    writeValue(file, graph_hash);
+
+    writeArray(file, betweenness);
+    writeArray(file, closeness);
+    writeArray(file, pagerank);
+
+    writeValue(file, static_cast<uint32_t>(communities.size()));
+    for (const auto &community : communities)
+    {
+        writeArray(file, community);
+    }
+
+    file.close();
+    if (!file)
+    {
+        return false;
+    }
+    return rename(temp_path.c_str(), file_path.c_str()) == 0;
+}
+
+bool AnalyticsSnapshot::loadFromFile(const string &file_path)
+{
+    ifstream file(file_path, ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // Read into a local, so a truncated or corrupt file leaves this snapshot unchanged
+    AnalyticsSnapshot loaded;
+    char magic[4];
+    uint32_t format_version;
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, SnapshotMagic, sizeof(magic)) != 0 ||
+        !readValue(file, format_version) || format_version != SnapshotFormatVersion ||
+        !readValue(file, loaded.graph_hash))
+    {
+        return false;
+    }
+
+    if (!readArray(file, loaded.betweenness) || !readArray(file, loaded.closeness) || !readArray(file, loaded.pagerank))
+    {
+        return false;
+    }
+
+    // Every community stores at least its member count, which bounds a corrupt count by the file size
+    uint32_t num_communities;
+    if (!readValue(file, num_communities) || num_communities > remainingBytes(file) / sizeof(uint32_t))
+    {
+        return false;
+    }
+    loaded.communities.resize(num_communities);
+    for (auto &community : loaded.communities)
+    {
+        if (!readArray(file, community))
+            return false;
+    }
+
+    *this = move(loaded);
+    return true;
+}
@@ -0,0 +1,358 @@
+#include "connection_manager.h"
+#include "adjacency_matrix.h"
+#include "edge_store.h"
+#include "graph_visualizer.h"
+#include <bits/stdc++.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// Benchmark suite: generates networks of increasing size and times the main
+// operations at several thread counts. Results are written as a JSON array.
+//
+//   benchmark [--sizes 250,500,1000] [--threads 1,2,4] [--repeat 3]
+//             [--output benchmark_results.json] [--work-dir bench_data]
+
+struct BenchmarkResult
+{
+    string name;
+    size_t users;
+    size_t edges;
+    int threads;
+    int repeat;
+    double seconds_min;
+    double seconds_mean;
+    double operations; // Work items per run, for throughput
+    long peak_rss_kb;
+};
+
+// Static Helper Functions
+static long peakRssKb()
+{
+#ifndef _WIN32
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1; // Not measured on Windows
+#endif
+}
+
+static void setThreads(int threads)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#else
+    (void)threads;
+#endif
+}
+
+static vector<size_t> parseList(const string &text)
+{
+    vector<size_t> values;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        if (!item.empty())
+            values.push_back(stoul(item));
+    }
+    return values;
+}
+
+// Times fn() `repeat` times and keeps the fastest and the mean run
+template <typename Fn>
+static pair<double, double> timeRuns(int repeat, Fn fn)
+{
+    double best = numeric_limits<double>::max(), total = 0.0;
+    for (int i = 0; i < repeat; i++)
+    {
+        auto start = chrono::steady_clock::now();
+        fn();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        best = min(best, seconds);
+        total += seconds;
+    }
+    return {best, total / repeat};
+}
+
+// Stream buffer that only counts bytes, so DOT generation is timed without I/O
+class CountingBuffer : public streambuf
+{
+public:
+    size_t bytes = 0;
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        bytes++;
+        return traits_type::not_eof(ch);
+    }
+    streamsize xsputn(const char *, streamsize count) override
+    {
+        bytes += count;
+        return count;
+    }
+};
+
+// Writes user_data.csv and connections.bin for a network of num_users users.
+// Users share (category, branch) groups; most edges stay inside a group.
+static size_t generateNetwork(size_t num_users, unsigned seed)
+{
+    const vector<string> categories = {"Engineering", "Finance", "Marketing", "Design", "Research"};
+    const vector<string> branches = {"software", "accounting", "digital", "product", "data"};
+    const size_t num_groups = categories.size() * branches.size();
+
+    mt19937 rng(seed);
+    uniform_real_distribution<double> influence(0.0, 100.0);
+
+    ofstream users_file("user_data.csv");
+    users_file << "name,id,password,category,influence,branch\n";
+    vector<vector<size_t>> groups(num_groups);
+    for (size_t i = 0; i < num_users; i++)
+    {
+        size_t group = rng() % num_groups;
+        groups[group].push_back(i);
+        users_file << "User " << i + 1 << ",user" << i + 1 << ",password" << i + 1 << ","
+                   << categories[group / branches.size()] << "," << fixed << setprecision(1) << influence(rng) << ","
+                   << branches[group % branches.size()] << "\n";
+    }
+
+    // About four edges per user, 80% inside the group
+    unordered_map<string, vector<string>> connections;
+    size_t num_edges = 0;
+    for (const auto &group : groups)
+    {
+        for (size_t user : group)
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                size_t other = rng() % 5 ? group[rng() % group.size()] : rng() % num_users;
+                if (other == user)
+                    continue;
+                string a = "user" + to_string(user + 1), b = "user" + to_string(other + 1);
+                connections[a].push_back(b);
+                connections[b].push_back(a);
+                num_edges++;
+            }
+        }
+    }
+
+    EdgeStore("connections.bin").save(connections);
+    return num_edges;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes = {250, 500, 1000};
+    vector<size_t> thread_counts = {1};
+#ifdef _OPENMP
+    thread_counts = {1, static_cast<size_t>(omp_get_max_threads())};
+#endif
+    int repeat = 3;
+    string output_file = "benchmark_results.json";
+    string work_dir = "bench_data";
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        string flag = argv[i];
+        if (flag == "--sizes")
+            sizes = parseList(argv[i + 1]);
+        else if (flag == "--threads")
+            thread_counts = parseList(argv[i + 1]);
+        else if (flag == "--repeat")
+            repeat = max(1, atoi(argv[i + 1]));
+        else if (flag == "--output")
+            output_file = argv[i + 1];
+        else if (flag == "--work-dir")
+            work_dir = argv[i + 1];
+        else
+        {
+            cerr << "Unknown option: " << flag << endl;
+            return 1;
+        }
+    }
+    sort(thread_counts.begin(), thread_counts.end()); // Ascending, so back() is the largest count
+    thread_counts.erase(unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+
+    // The managers read and write their files in the working directory
+    filesystem::path original_dir = filesystem::current_path();
+    output_file = filesystem::absolute(output_file).string();
+
+    vector<BenchmarkResult> results;
+    auto record = [&](const string &name, size_t users, size_t edges, int threads,
+                      pair<double, double> timing, double operations)
+    {
+        results.push_back({name, users, edges, threads, repeat, timing.first, timing.second, operations, peakRssKb()});
+        cout << left << setw(22) << name << " users=" << setw(7) << users << " threads=" << setw(3) << threads
+             << " min=" << fixed << setprecision(4) << timing.first << "s"
+             << " ops/s=" << setprecision(1) << operations / max(timing.first, 1e-9) << endl;
+    };
+
+    for (size_t num_users : sizes)
+    {
+        filesystem::path dir = original_dir / work_dir / ("users_" + to_string(num_users));
+        filesystem::remove_all(dir);
+        filesystem::create_directories(dir);
+        filesystem::current_path(dir);
+
+        size_t num_edges = generateNetwork(num_users, 42);
+        setThreads(thread_counts.back());
+
+        // Startup: CSV users, edge store, communities, base matrix, similarity index
+        ConnectionManager *cm = nullptr;
+        auto load = timeRuns(1, [&]()
+        {
+            cm = new ConnectionManager("user_data.csv");
+        });
+        record("load", num_users, num_edges, thread_counts.back(), load, num_users);
+
+        vector<User *> users = cm->getAllUsers();
+        vector<string> user_ids;
+        for (User *user : users)
+        {
+            user_ids.push_back(user->getID());
+        }
+
+        // Matrix update, save and load over all users
+        {
+            AdjacencyMatrix matrix("bench_matrix.csv");
+            matrix.addNewUsers(user_ids);
+            unordered_map<string, int> community_of;
+            const vector<vector<User *>> &communities = cm->getCommunities();
+            for (size_t i = 0; i < communities.size(); i++)
+            {
+                for (User *user : communities[i])
+                {
+                    community_of[user->getID()] = i;
+                }
+            }
+
+            vector<pair<string, string>> pairs;
+            mt19937 rng(7);
+            for (size_t i = 0; i < num_users; i++)
+            {
+                pairs.emplace_back(user_ids[rng() % num_users], user_ids[rng() % num_users]);
+            }
+            auto update = timeRuns(repeat, [&]()
+            {
+                for (const auto &p : pairs)
+                {
+                    matrix.updateConnection(p.first, p.second, community_of[p.first], community_of[p.second], false);
+                }
+            });
+            record("matrix_update", num_users, num_edges, 1, update, pairs.size());
+
+            auto save = timeRuns(repeat, [&]()
+            {
+                matrix.saveToFile();
+            });
+            record("matrix_save", num_users, num_edges, 1, save, double(num_users) * num_users);
+
+            auto load_matrix = timeRuns(repeat, [&]()
+            {
+                matrix.loadFromFile();
+            });
+            record("matrix_load", num_users, num_edges, 1, load_matrix, double(num_users) * num_users);
+
+            // DOT text for the updated pairs, counted instead of written
+            const unordered_map<string, int> &index_of = matrix.getUserIndexMap();
+            set<pair<size_t, size_t>> edge_pairs;
+            for (const auto &p : pairs)
+            {
+                size_t a = index_of.at(p.first), b = index_of.at(p.second);
+                if (a != b)
+                {
+                    edge_pairs.emplace(min(a, b), max(a, b));
+                }
+            }
+            vector<GraphVisualizer::Edge> edges;
+            for (const auto &edge : edge_pairs)
+            {
+                edges.push_back({edge.first, edge.second, matrix.getMatrix()[edge.first][edge.second]});
+            }
+
+            GraphVisualizer visualizer(15.0);
+            auto dot = timeRuns(repeat, [&]()
+            {
+                CountingBuffer buffer;
+                ostream out(&buffer);
+                visualizer.writeDotFormat(out, matrix.getUserIds(), edges, communities);
+            });
+            record("dot_generation", num_users, num_edges, 1, dot, num_users);
+        }
+
+        for (size_t threads : thread_counts)
+        {
+            setThreads(threads);
+
+            auto communities = timeRuns(repeat, [&]()
+            {
+                cm->detectCommunities();
+            });
+            record("detect_communities", num_users, num_edges, threads, communities, num_users);
+
+            auto betweenness = timeRuns(repeat, [&]()
+            {
+                cm->calculateBetweennessCentrality();
+            });
+            record("betweenness", num_users, num_edges, threads, betweenness, num_users);
+
+            auto closeness = timeRuns(repeat, [&]()
+            {
+                cm->calculateClosenessCentrality();
+            });
+            record("closeness", num_users, num_edges, threads, closeness, num_users);
+
+            auto pagerank = timeRuns(repeat, [&]()
+            {
+                cm->calculatePageRank();
+            });
+            record("pagerank", num_users, num_edges, threads, pagerank, num_users);
+        }
+
+        // Recommendations are cached per user, so every run takes fresh users
+        {
+            size_t per_run = min<size_t>(num_users / repeat, 100);
+            size_t next_user = 0;
+            auto recommend = timeRuns(repeat, [&]()
+            {
+                for (size_t i = 0; i < per_run; i++)
+                {
+                    cm->recommendConnectionsForNewUser(users[next_user++]);
+                }
+            });
+            record("recommend", num_users, num_edges, 1, recommend, per_run);
+        }
+
+        delete cm;
+        filesystem::current_path(original_dir);
+    }
+
+    // Machine-readable output
+    ofstream json(output_file);
+    json << "[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &r = results[i];
+        json << "  {\"benchmark\": \"" << r.name << "\", \"users\": " << r.users << ", \"edges\": " << r.edges
+             << ", \"threads\": " << r.threads << ", \"repeat\": " << r.repeat
+             << ", \"seconds_min\": " << setprecision(6) << r.seconds_min << ", \"seconds_mean\": " << r.seconds_mean
+             << ", \"ops_per_second\": " << r.operations / max(r.seconds_min, 1e-9)
+             << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "]\n";
+    cout << "Wrote " << results.size() << " results to " << output_file << endl;
+    return 0;
+}
@@ -22,6 +22,9 @@ void ConnectionHandler::handleConnectionManagement(ConnectionManager &cm, User *
             removeConnection(cm, user);
             break;
         case 4:
+            findConnectionPath(cm, user);
+            break;
+        case 5:
             return;
         default:
             cout << "Invalid option. Please try again." << endl;
@@ -35,7 +38,8 @@ int ConnectionHandler::getMenuChoice()
     cout << "1. View your connections" << endl;
     cout << "2. Add new connection" << endl;
     cout << "3. Remove connection" << endl;
-    cout << "4. Exit" << endl;
+    cout << "4. How am I connected to someone?" << endl;
+    cout << "5. Exit" << endl;
     cout << "Choose an option: ";
 
     int choice;
@@ -88,3 +92,31 @@ void ConnectionHandler::removeConnection(ConnectionManager &cm, User *user)
         cout << "Invalid user ID or not in your connections." << endl;
     }
 }
+
+void ConnectionHandler::findConnectionPath(ConnectionManager &cm, User *user)
+{
+    cout << "\nEnter the ID of the user: ";
+    string target_id;
+    cin >> target_id;
+
+    User *target = cm.getUser(target_id);
+    if (!target)
+    {
+        cout << "Invalid user ID." << endl;
+        return;
+    }
+
+    vector<User *> path = cm.findShortestPath(user, target);
+    if (path.empty())
+    {
+        cout << "You are not connected to " << target->getName() << "." << endl;
+        return;
+    }
+
+    cout << "Degrees of separation: " << path.size() - 1 << endl;
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        cout << (i ? " -> " : "") << path[i]->getName() << " (" << path[i]->getID() << ")";
+    }
+    cout << endl;
+}
@@ -2,15 +2,48 @@
 #include <bits/stdc++.h>
 #include <omp.h>
 #include "graph_visualizer.h"
+#include "link_predictor.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_accounting.h"
 
 using namespace std;
 
+// Metrics
+static const Metrics::Counter bfs_traversals = Metrics::counter("cm_bfs_traversals_total", "Breadth-first searches run by the analytics");
+static const Metrics::Counter bfs_edges = Metrics::counter("cm_bfs_edges_total", "Edges examined by breadth-first searches");
+static const Metrics::Counter connections_added = Metrics::counter("cm_connections_added_total", "Connections created");
+static const Metrics::Counter connections_removed = Metrics::counter("cm_connections_removed_total", "Connections removed");
+static const Metrics::Counter users_added = Metrics::counter("cm_users_added_total", "Users added to the network");
+static const Metrics::Counter recommendation_cache_hits = Metrics::counter("cm_recommendation_cache_hits_total", "Recommendations served from the cache");
+static const Metrics::Counter recommendation_cache_misses = Metrics::counter("cm_recommendation_cache_misses_total", "Recommendations that had to be ranked");
+static const Metrics::Histogram detect_communities_seconds = Metrics::histogram("cm_detect_communities_seconds", "Community detection runs");
+static const Metrics::Histogram betweenness_seconds = Metrics::histogram("cm_betweenness_seconds", "Betweenness centrality runs");
+static const Metrics::Histogram closeness_seconds = Metrics::histogram("cm_closeness_seconds", "Closeness centrality runs");
+static const Metrics::Histogram pagerank_seconds = Metrics::histogram("cm_pagerank_seconds", "PageRank runs");
+static const Metrics::Histogram recommend_seconds = Metrics::histogram("cm_recommend_seconds", "Recommendation requests, cache hits included");
+static const Metrics::Histogram shortest_path_seconds = Metrics::histogram("cm_shortest_path_seconds", "Degrees-of-separation queries");
+static const Metrics::Histogram persist_seconds = Metrics::histogram("cm_persist_seconds", "Saves of the matrix and the edge store");
+
 class GraphTraversal
 {
 public:
-    template <typename ProcessNode, typename ProcessEdge>
+    // Neighbor lookup for the graph representations in use
+    static const vector<string> &neighborsOf(const unordered_map<string, vector<string>> &graph, const string &id)
+    {
+        static const vector<string> empty;
+        auto it = graph.find(id);
+        return it != graph.end() ? it->second : empty;
+    }
+
+    static const vector<string> &neighborsOf(const GraphSnapshot &graph, const string &id)
+    {
+        return graph.neighbors(id);
+    }
+
+    template <typename Graph, typename ProcessNode, typename ProcessEdge>
     static void bfs(
-        const unordered_map<string, vector<string>> &graph,
+        const Graph &graph,
         const string &start_id,
         ProcessNode process_node,
         ProcessEdge process_edge)
@@ -20,6 +53,7 @@ public:
 
         visited[start_id] = true;
         queue.push(start_id);
+        uint64_t edges_examined = 0;
 
         while (!queue.empty())
         {
@@ -28,24 +62,26 @@ public:
 
             process_node(current);
 
-            if (graph.find(current) != graph.end())
+            for (const auto &neighbor : neighborsOf(graph, current))
             {
-                for (const auto &neighbor : graph.at(current))
-                {
-                    process_edge(current, neighbor);
+                process_edge(current, neighbor);
+                edges_examined++;
 
-                    if (!visited[neighbor])
-                    {
-                        visited[neighbor] = true;
-                        queue.push(neighbor);
-                    }
+                if (!visited[neighbor])
+                {
+                    visited[neighbor] = true;
+                    queue.push(neighbor);
                 }
             }
         }
+
+        bfs_traversals.add();
+        bfs_edges.add(edges_examined);
     }
 
+    template <typename Graph>
     static unordered_map<string, double> bfsDistance(
-        const unordered_map<string, vector<string>> &graph,
+        const Graph &graph,
         const string &start_id)
     {
         unordered_map<string, double> distances;
@@ -71,58 +107,34 @@ public:
 
         return distances;
     }
-
-    static vector<string> bfsPath(
-        const unordered_map<string, vector<string>> &graph,
-        const string &start_id,
-        const string &end_id)
-    {
-        unordered_map<string, string> predecessors;
-        bool found = false;
-
-        bfs(
-            graph,
-            start_id,
-            [&](const string &node)
-            {
-                if (node == end_id)
-                {
-                    found = true;
-                }
-            },
-            [&](const string &from, const string &to)
-            {
-                if (predecessors.find(to) == predecessors.end())
-                {
-                    predecessors[to] = from;
-                }
-            });
-
-        if (!found)
-        {
-            return vector<string>();
-        }
-
-        vector<string> path;
-        string current = end_id;
-        while (current != start_id)
-        {
-            path.push_back(current);
-            current = predecessors[current];
-        }
-        path.push_back(start_id);
-        reverse(path.begin(), path.end());
-
-        return path;
-    }
 };
 
 ConnectionManager::ConnectionManager(const string &user_data_file)
-    : adjacency_matrix(new AdjacencyMatrix("adjacency_matrix.csv"))
+    : adjacency_matrix(new AdjacencyMatrix("adjacency_matrix.csv")), edge_store("connections.bin"),
+      user_data_path(user_data_file)
 {
+    Trace::Span span("startup", "startup");
     loadUserData(user_data_file);
     initializeAdjacencyMatrix();
-    establishConnections();
+
+    // Reuse the persisted graph so analytics are stable across restarts
+    if (edge_store.load(connections))
+    {
+        snapshot.reset();
+        graph_version++;
+    }
+    else
+    {
+        establishConnections();
+        edge_store.save(connections);
+    }
+    rebuildSimilarityIndex();
+
+    // Warm start: reuse analytics computed on this exact graph by a previous run
+    if (loadAnalyticsSnapshot("analytics_snapshot.bin"))
+    {
+        cout << "Loaded analytics snapshot." << endl;
+    }
 }
 
 // ConnectionManager::~ConnectionManager() {
@@ -131,6 +143,7 @@ ConnectionManager::ConnectionManager(const string &user_data_file)
 
 void ConnectionManager::initializeAdjacencyMatrix()
 {
+    Trace::Span span("matrix init", "startup");
     // Only initialize the matrix for the first InitialNum users
     vector<User *> initial_users;
     for (int i = 0; i < min(InitialNum, (int)users.size()); i++)
@@ -138,12 +151,18 @@ void ConnectionManager::initializeAdjacencyMatrix()
         initial_users.push_back(users[i]);
     }
 
-    vector<vector<User *>> communities = detectCommunities();
-    adjacency_matrix->initializeBaseMatrix(initial_users, communities);
+    adjacency_matrix->initializeBaseMatrix(initial_users, getCommunities());
 }
 
 void ConnectionManager::addConnection(User *user1, User *user2)
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Connections);
+    if (isValidConnection(user1->getID(), user2->getID()))
+    {
+        cout << "These users are already connected." << endl;
+        return;
+    }
+
     // First ensure both users are in the adjacency matrix
     adjacency_matrix->addNewUser(user1->getID());
     adjacency_matrix->addNewUser(user2->getID());
@@ -151,14 +170,32 @@ void ConnectionManager::addConnection(User *user1, User *user2)
     // Add the connection to the connection map
     connections[user1->getID()].push_back(user2->getID());
     connections[user2->getID()].push_back(user1->getID());
-
-    // Update the adjacency matrix with the new connection and weight
-    vector<vector<User *>> communities = detectCommunities();
-    adjacency_matrix->updateConnection(user1->getID(), user2->getID(), communities);
+    connections_added.add();
+
+    // Each user gains the other as a neighbor token; both the old and the new bucket mates are affected
+    invalidateSimilarUsers(user1->getID());
+    invalidateSimilarUsers(user2->getID());
+    similarity_index.addToken(user1->getID(), "neighbor:" + user2->getID());
+    similarity_index.addToken(user2->getID(), "neighbor:" + user1->getID());
+    invalidateSimilarUsers(user1->getID());
+    invalidateSimilarUsers(user2->getID());
+
+    // Both two-hop neighborhoods changed (after adding, they include the old ones)
+    invalidateNeighborhood(user1->getID());
+    invalidateNeighborhood(user2->getID());
+    markAdjacencyDirty(user1->getID());
+    markAdjacencyDirty(user2->getID());
+    graph_version++;
+
+    // Weighted by the last detected communities; the next reader reruns detection
+    adjacency_matrix->updateConnection(user1->getID(), user2->getID(),
+                                       getCommunityIndex(user1->getID()), getCommunityIndex(user2->getID()));
+    persistGraph();
 }
 
 void ConnectionManager::removeConnection(User *user1, User *user2)
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Connections);
     if (!isValidConnection(user1->getID(), user2->getID()))
     {
         cout << "No valid connection exists between these users." << endl;
@@ -167,6 +204,16 @@ void ConnectionManager::removeConnection(User *user1, User *user2)
 
     // Remove the connection from the adjacency matrix
     adjacency_matrix->removeConnection(user1->getID(), user2->getID());
+    connections_removed.add();
+
+    // Invalidate while the old neighbors are still listed
+    invalidateNeighborhood(user1->getID());
+    invalidateNeighborhood(user2->getID());
+    invalidateSimilarUsers(user1->getID());
+    invalidateSimilarUsers(user2->getID());
+    markAdjacencyDirty(user1->getID());
+    markAdjacencyDirty(user2->getID());
+    graph_version++;
 
     // Update the connections map
     connections[user1->getID()].erase(
@@ -180,105 +227,940 @@ void ConnectionManager::removeConnection(User *user1, User *user2)
                connections[user2->getID()].end(),
                user1->getID()),
         connections[user2->getID()].end());
+
+    // MinHash cannot forget a token, so recompute both signatures
+    similarity_index.updateUser(user1->getID(), getSimilarityTokens(user1));
+    similarity_index.updateUser(user2->getID(), getSimilarityTokens(user2));
+    invalidateSimilarUsers(user1->getID());
+    invalidateSimilarUsers(user2->getID());
+
+    persistGraph();
+}
+
+bool ConnectionManager::isValidConnection(const string &user1_id, const string &user2_id)
+{
+    // Use the public getConnectionWeight method instead of accessing private matrix directly
+    double weight = adjacency_matrix->getConnectionWeight(user1_id, user2_id);
+    return weight >= 13.0;
+}
+
+vector<pair<User *, double>> ConnectionManager::getConnections(User *user) const
+{
+    vector<pair<User *, double>> result;
+
+    // Get all users and check connections with weight threshold
+    for (const auto &other_user : users)
+    {
+        if (other_user->getID() != user->getID())
+        { // Don't check connection with self
+            double weight = adjacency_matrix->getConnectionWeight(user->getID(), other_user->getID());
+
+            if (weight >= 13.0)
+            {
+                result.emplace_back(other_user, weight);
+            }
+        }
+    }
+    return result;
+}
+
+void ConnectionManager::viewConnections(User *user)
+{
+    cout << "Connections for " << user->getName() << ":" << endl;
+
+    vector<pair<User *, double>> user_connections = getConnections(user);
+    for (const auto &connection : user_connections)
+    {
+        cout << connection.first->getName()
+             << " (ID: " << connection.first->getID()
+             << ", Weight: " << connection.second << ")" << endl;
+    }
+
+    if (user_connections.empty())
+    {
+        cout << "No valid connections found (weight >= 15.0)." << endl;
+    }
+}
+
+void ConnectionManager::addUser(User *new_user)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Connections);
+    users_added.add();
+
+    // Add user to the adjacency matrix first
+    adjacency_matrix->addNewUser(new_user->getID());
+
+    // Add connections based on category and branch
+    connections[new_user->getID()] = {};
+
+    for (User *user : users)
+    {
+        if (user != new_user &&
+            user->getCategoryCode() == new_user->getCategoryCode() &&
+            user->getBranchCode() == new_user->getBranchCode())
+        {
+
+            if (connections[new_user->getID()].size() < 5 &&
+                connections[user->getID()].size() < 5)
+            {
+
+                connections[new_user->getID()].push_back(user->getID());
+                connections[user->getID()].push_back(new_user->getID());
+                similarity_index.addToken(user->getID(), "neighbor:" + new_user->getID());
+                markAdjacencyDirty(user->getID());
+
+                // Update the connection weight in the adjacency matrix
+                adjacency_matrix->updateConnection(new_user->getID(), user->getID(), -1, getCommunityIndex(user->getID()));
+            }
+        }
+    }
+
+    {
+        MemoryAccounting::Scope users_scope(MemoryAccounting::Subsystem::Users);
+        users.push_back(new_user);
+        user_lookup[new_user->getID()] = new_user;
+    }
+    similarity_index.updateUser(new_user->getID(), getSimilarityTokens(new_user));
+    markAdjacencyDirty(new_user->getID());
+    snapshot_users_changed = true;
+
+    // A new user is a candidate for everyone, so every cached list is stale
+    clearRecommendations();
+    graph_version++;
+
+    persistGraph();
+}
+
+void ConnectionManager::addUsers(const vector<User *> &new_users)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Connections);
+    if (new_users.empty())
+    {
+        return;
+    }
+    users_added.add(new_users.size());
+
+    // Grow the matrix once for the whole batch
+    vector<string> new_ids;
+    new_ids.reserve(new_users.size());
+    for (User *new_user : new_users)
+    {
+        new_ids.push_back(new_user->getID());
+    }
+    adjacency_matrix->addNewUsers(new_ids);
+
+    // Bucket users that can still take connections by (branch, category) code
+    size_t num_categories = user_store.getCategoryDictionary().size();
+    size_t num_branches = user_store.getBranchDictionary().size();
+    vector<vector<User *>> open_users(num_branches * num_categories);
+    for (User *user : users)
+    {
+        if (connections[user->getID()].size() < 5)
+        {
+            open_users[user->getBranchCode() * num_categories + user->getCategoryCode()].push_back(user);
+        }
+    }
+
+    // Same matching rule as addUser, as if the batch were registered in order
+    vector<pair<User *, User *>> new_edges;
+    for (User *new_user : new_users)
+    {
+        auto &new_connections = connections[new_user->getID()];
+        auto &bucket = open_users[new_user->getBranchCode() * num_categories + new_user->getCategoryCode()];
+
+        // Walk the bucket in order, dropping users that have filled up
+        size_t kept = 0;
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            User *user = bucket[i];
+            auto &user_connections = connections[user->getID()];
+            if (new_connections.size() < 5 && user_connections.size() < 5)
+            {
+                new_connections.push_back(user->getID());
+                user_connections.push_back(new_user->getID());
+                new_edges.emplace_back(new_user, user);
+                markAdjacencyDirty(user->getID());
+            }
+            if (user_connections.size() < 5)
+            {
+                bucket[kept++] = user;
+            }
+        }
+        bucket.resize(kept);
+
+        if (new_connections.size() < 5)
+        {
+            bucket.push_back(new_user);
+        }
+
+        MemoryAccounting::Scope users_scope(MemoryAccounting::Subsystem::Users);
+        users.push_back(new_user);
+        user_lookup[new_user->getID()] = new_user;
+        markAdjacencyDirty(new_user->getID());
+    }
+    snapshot_users_changed = true;
+
+    // Weight every new edge by the last detected communities (new users have none yet) and persist once
+    graph_version++;
+    for (const auto &edge : new_edges)
+    {
+        adjacency_matrix->updateConnection(edge.first->getID(), edge.second->getID(), -1,
+                                           getCommunityIndex(edge.second->getID()), false);
+    }
+    persistGraph();
+
+    for (const auto &edge : new_edges)
+    {
+        similarity_index.addToken(edge.second->getID(), "neighbor:" + edge.first->getID());
+    }
+    for (User *new_user : new_users)
+    {
+        similarity_index.updateUser(new_user->getID(), getSimilarityTokens(new_user));
+    }
+
+    clearRecommendations();
+}
+
+void ConnectionManager::markAdjacencyDirty(const string &user_id)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Snapshots);
+    // Before the first snapshot everything is copied anyway
+    if (snapshot)
+    {
+        dirty_adjacency.insert(user_id);
+    }
+}
+
+// Cached rankings stay exact: an edge change at a user alters its own candidates,
+// the Adamic-Adar terms (its degree) of its neighbors, and the Jaccard terms of
+// everyone who reaches it as a friend-of-friend, i.e. all users within two hops.
+// Callers invalidate on the larger side of the change (before removing an edge,
+// after adding one).
+void ConnectionManager::invalidateNeighborhood(const string &user_id)
+{
+    eraseRecommendations(user_id);
+
+    auto it = connections.find(user_id);
+    if (it == connections.end())
+    {
+        return;
+    }
+    for (const auto &neighbor_id : it->second)
+    {
+        eraseRecommendations(neighbor_id);
+        auto second_hop = connections.find(neighbor_id);
+        if (second_hop != connections.end())
+        {
+            for (const auto &two_hop_id : second_hop->second)
+            {
+                eraseRecommendations(two_hop_id);
+            }
+        }
+    }
+}
+
+// A new signature moves the user between LSH buckets, which changes the
+// candidates of whoever shares a bucket with it; callers invalidate against the
+// signature before and after the update. This query is uncapped on purpose:
+// any bucket mate may have had the user among its top candidates.
+void ConnectionManager::invalidateSimilarUsers(const string &user_id)
+{
+    for (const auto &similar_id : similarity_index.query(user_id))
+    {
+        eraseRecommendations(similar_id);
+    }
+}
+
+void ConnectionManager::eraseRecommendations(const string &user_id)
+{
+    RecommendationShard &shard = getRecommendationShard(user_id);
+    lock_guard<mutex> lock(shard.lock);
+    shard.entries.erase(user_id);
+}
+
+ConnectionManager::RecommendationShard &ConnectionManager::getRecommendationShard(const string &user_id)
+{
+    User *user = getUser(user_id);
+    return recommendation_cache[user ? user->getSlot() % recommendation_cache.size() : 0];
+}
+
+void ConnectionManager::clearRecommendations()
+{
+    for (auto &shard : recommendation_cache)
+    {
+        lock_guard<mutex> lock(shard.lock);
+        shard.entries.clear();
+    }
+}
+
+void ConnectionManager::persistGraph()
+{
+    if (!persistence_thread.joinable())
+    {
+        Metrics::ScopedTimer timer(persist_seconds);
+        Trace::Span span("persist", "io");
+        adjacency_matrix->forceSave();
+        edge_store.save(connections);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(persistence_mutex);
+        persistence_pending = true;
+    }
+    persistence_cv.notify_one();
+}
+
+bool ConnectionManager::persistNewUsers(const vector<User *> &new_users)
+{
+    // Rows are formatted now, the writer thread never touches User handles
+    ostringstream rows;
+    for (User *user : new_users)
+    {
+        rows << user->getName() << ","
+             << user->getID() << ","
+             << user->getPassword() << ","
+             << user->getCategory() << ","
+             << user->getInfluence() << ","
+             << user->getBranch() << "\n";
+    }
+
+    if (!persistence_thread.joinable())
+    {
+        return appendUserRows(rows.str());
+    }
+
+    {
+        lock_guard<mutex> lock(persistence_mutex);
+        pending_user_rows += rows.str();
+        persistence_pending = true;
+    }
+    persistence_cv.notify_one();
+    return true;
+}
+
+bool ConnectionManager::appendUserRows(const string &rows)
+{
+    if (rows.empty())
+    {
+        return true;
+    }
+
+    ofstream file(user_data_path, ios::app);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open " << user_data_path << " to save new users." << endl;
+        return false;
+    }
+    file << rows;
+    return static_cast<bool>(file);
+}
+
+void ConnectionManager::startBackgroundPersistence()
+{
+    if (persistence_thread.joinable())
+    {
+        return;
+    }
+
+    adjacency_matrix->setDeferredSaves(true);
+    persistence_stopping = false;
+    persistence_thread = thread(&ConnectionManager::runPersistence, this);
+}
+
+void ConnectionManager::stopBackgroundPersistence()
+{
+    if (!persistence_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(persistence_mutex);
+        persistence_stopping = true;
+    }
+    persistence_cv.notify_one();
+    persistence_thread.join();
+    adjacency_matrix->setDeferredSaves(false);
+}
+
+void ConnectionManager::runPersistence()
+{
+    Trace::setThreadName("persistence");
+    unique_lock<mutex> lock(persistence_mutex);
+    while (true)
+    {
+        persistence_cv.wait(lock, [this]
+                            { return persistence_pending || persistence_stopping; });
+        if (!persistence_pending)
+        {
+            return; // Stopping with nothing left to write
+        }
+        persistence_pending = false;
+        string user_rows;
+        user_rows.swap(pending_user_rows);
+        lock.unlock();
+
+        // New users first, so the saved edges never name a user the file lacks
+        appendUserRows(user_rows);
+
+        // Readers keep going; writers wait until both files are consistent with each other
+        {
+            shared_lock<shared_mutex> graph_lock(graph_mutex);
+            Metrics::ScopedTimer timer(persist_seconds);
+            Trace::Span span("persist", "io");
+            adjacency_matrix->forceSave();
+            edge_store.save(connections);
+        }
+
+        lock.lock();
+    }
+}
+
+User *ConnectionManager::createUser(const string &name, const string &id, const string &password,
+                                    const string &category, double influence, const string &branch)
+{
+    return user_store.addUser(name, id, password, category, influence, branch);
+}
+
+vector<string> ConnectionManager::getSimilarityTokens(User *user)
+{
+    // Neighbors only: shared category/branch tokens gave low-degree users identical
+    // signatures, and rankRecommendations scores those attributes anyway
+    vector<string> tokens;
+    auto it = connections.find(user->getID());
+    if (it != connections.end())
+    {
+        for (const auto &neighbor_id : it->second)
+        {
+            tokens.push_back("neighbor:" + neighbor_id);
+        }
+    }
+    return tokens;
+}
+
+void ConnectionManager::rebuildSimilarityIndex()
+{
+    Trace::Span span("similarity index", "startup");
+    similarity_index.clear();
+    for (User *user : users)
+    {
+        similarity_index.updateUser(user->getID(), getSimilarityTokens(user));
+    }
+}
+
+double ConnectionManager::getConnectionWeight(const string &user1_id, const string &user2_id) const
+{
+    return adjacency_matrix->getConnectionWeight(user1_id, user2_id);
+}
+
+unordered_map<string, vector<LinkPredictor::LinkScore>> ConnectionManager::predictLinksForAllUsers(size_t top_k)
+{
+    vector<string> user_ids;
+    user_ids.reserve(users.size());
+    for (User *user : users)
+    {
+        user_ids.push_back(user->getID());
+    }
+
+    return getLinkPredictor()->predictAll(user_ids, top_k);
+}
+
+shared_ptr<const LinkPredictor> ConnectionManager::getLinkPredictor()
+{
+    lock_guard<mutex> lock(link_predictor_mutex);
+    if (!link_predictor || link_predictor_version != graph_version)
+    {
+        MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Recommendations);
+        link_predictor = make_shared<const LinkPredictor>(connections);
+        link_predictor_version = graph_version;
+    }
+    return link_predictor;
+}
+
+const unordered_map<string, double> &ConnectionManager::getCachedScores(CachedScores &cache,
+                                                                      unordered_map<string, double> (ConnectionManager::*compute)())
+{
+    lock_guard<mutex> lock(scores_mutex);
+    if (cache.version != graph_version)
+    {
+        cache.scores = (this->*compute)();
+        cache.version = graph_version;
+        updateLeaderboard(cache);
+    }
+    return cache.scores;
+}
+
+void ConnectionManager::updateLeaderboard(CachedScores &cache)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::AnalyticsCache);
+    // Only slots whose score moved touch the tree
+    for (const auto &entry : cache.scores)
+    {
+        User *user = getUser(entry.first);
+        if (user)
+        {
+            cache.leaderboard.update(user->getSlot(), entry.second);
+        }
+    }
+}
+
+vector<pair<User *, double>> ConnectionManager::getTopUsers(Centrality metric, size_t k)
+{
+    CachedScores &cache = metric == Centrality::PageRank      ? cached_pagerank
+                          : metric == Centrality::Betweenness ? cached_betweenness
+                                                              : cached_closeness;
+    unsigned long cached_version;
+    {
+        lock_guard<mutex> lock(scores_mutex);
+        cached_version = cache.version;
+    }
+
+    // Only the very first request waits for a full computation
+    if (cached_version == ~0UL)
+    {
+        if (metric == Centrality::PageRank)
+            getPageRank();
+        else if (metric == Centrality::Betweenness)
+            getBetweennessCentrality();
+        else
+            getClosenessCentrality();
+    }
+    else if (cached_version != graph_version)
+    {
+        refreshAnalytics();
+    }
+
+    vector<pair<User *, double>> top_users;
+    lock_guard<mutex> lock(scores_mutex);
+    for (const auto &entry : cache.leaderboard.top(k))
+    {
+        top_users.emplace_back(user_store.getUser(entry.first), entry.second);
+    }
+    return top_users;
+}
+
+const unordered_map<string, double> &ConnectionManager::getBetweennessCentrality()
+{
+    return getCachedScores(cached_betweenness, &ConnectionManager::calculateBetweennessCentrality);
+}
+
+const unordered_map<string, double> &ConnectionManager::getClosenessCentrality()
+{
+    return getCachedScores(cached_closeness, &ConnectionManager::calculateClosenessCentrality);
+}
+
+const unordered_map<string, double> &ConnectionManager::getPageRank()
+{
+    return getCachedScores(cached_pagerank, &ConnectionManager::calculatePageRank);
+}
+
+shared_ptr<const GraphSnapshot> ConnectionManager::getSnapshot()
+{
+    lock_guard<mutex> lock(snapshot_mutex);
+    if (snapshot && snapshot->version == graph_version)
+    {
+        return snapshot;
+    }
+    Trace::Span span("publish snapshot", "analytics");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Snapshots);
+
+    auto next = make_shared<GraphSnapshot>();
+    next->version = graph_version;
+
+    if (!snapshot || snapshot_users_changed)
+    {
+        auto user_ids = make_shared<vector<string>>();
+        user_ids->reserve(users.size());
+        for (User *user : users)
+        {
+            user_ids->push_back(user->getID());
+        }
+        next->user_ids = move(user_ids);
+    }
+    else
+    {
+        next->user_ids = snapshot->user_ids;
+    }
+
+    if (!snapshot)
+    {
+        next->adjacency.reserve(connections.size());
+        for (const auto &entry : connections)
+        {
+            next->adjacency[entry.first] = make_shared<const vector<string>>(entry.second);
+        }
+    }
+    else
+    {
+        // Share unchanged neighbor blocks, copy only the ones that changed
+        next->adjacency = snapshot->adjacency;
+        for (const auto &user_id : dirty_adjacency)
+        {
+            auto it = connections.find(user_id);
+            if (it != connections.end())
+            {
+                next->adjacency[user_id] = make_shared<const vector<string>>(it->second);
+            }
+            else
+            {
+                next->adjacency.erase(user_id);
+            }
+        }
+    }
+
+    dirty_adjacency.clear();
+    snapshot_users_changed = false;
+    snapshot = move(next);
+    return snapshot;
+}
+
+future<ConnectionManager::AnalyticsResults> ConnectionManager::computeAnalyticsInBackground()
+{
+    // The worker only sees the immutable snapshot, never the live maps
+    shared_ptr<const GraphSnapshot> graph = getSnapshot();
+    return async(launch::async, [graph]()
+    {
+        Trace::setThreadName("background analytics");
+        AnalyticsResults results;
+        results.version = graph->version;
+        results.betweenness = calculateBetweennessCentrality(*graph);
+        results.closeness = calculateClosenessCentrality(*graph);
+        results.pagerank = calculatePageRank(*graph);
+        return results;
+    });
+}
+
+bool ConnectionManager::installAnalytics(AnalyticsResults results)
+{
+    // Results for an older graph still replace older scores, so leaderboards keep up during bursts of edits.
+    // Scores a reader already computed for this version stay put, it may still hold a reference.
+    lock_guard<mutex> lock(scores_mutex);
+    bool installed = false;
+    auto install = [&](CachedScores &cache, unordered_map<string, double> &scores)
+    {
+        if (cache.version == ~0UL || cache.version < results.version)
+        {
+            cache.scores = move(scores);
+            cache.version = results.version;
+            updateLeaderboard(cache);
+            installed = true;
+        }
+    };
+    install(cached_betweenness, results.betweenness);
+    install(cached_closeness, results.closeness);
+    install(cached_pagerank, results.pagerank);
+    return installed;
+}
+
+void ConnectionManager::refreshAnalytics()
+{
+    lock_guard<mutex> lock(analytics_mutex);
+    if (pending_analytics.valid() && pending_analytics.wait_for(chrono::seconds(0)) == future_status::ready)
+    {
+        installAnalytics(pending_analytics.get());
+    }
+
+    // Only scores someone already asked for are kept fresh, the rest are computed on first use
+    bool stale;
+    {
+        lock_guard<mutex> scores_lock(scores_mutex);
+        auto isStale = [&](const CachedScores &cache)
+        {
+            return cache.version != ~0UL && cache.version != graph_version;
+        };
+        stale = isStale(cached_betweenness) || isStale(cached_closeness) || isStale(cached_pagerank);
+    }
+
+    // Start the next run once the graph has moved past the last one
+    if (stale && !pending_analytics.valid() && analytics_version != graph_version)
+    {
+        analytics_version = graph_version;
+        pending_analytics = computeAnalyticsInBackground();
+    }
+}
+
+void ConnectionManager::finishAnalytics()
+{
+    lock_guard<mutex> lock(analytics_mutex);
+    if (pending_analytics.valid())
+    {
+        installAnalytics(pending_analytics.get());
+    }
+}
+
+shared_ptr<const DenseGraph> ConnectionManager::getDenseGraph()
+{
+    shared_ptr<const GraphSnapshot> graph = getSnapshot();
+    lock_guard<mutex> lock(dense_graph_mutex);
+    if (!dense_graph || dense_graph->getVersion() != graph->version)
+    {
+        MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Snapshots);
+        dense_graph = make_shared<const DenseGraph>(*graph);
+    }
+    return dense_graph;
+}
+
+vector<User *> ConnectionManager::findShortestPath(User *from, User *to)
+{
+    vector<User *> path;
+    for (const string &user_id : findShortestPath(*getDenseGraph(), from->getID(), to->getID()))
+    {
+        path.push_back(getUser(user_id));
+    }
+    return path;
+}
+
+vector<string> ConnectionManager::findShortestPath(const DenseGraph &graph, const string &from_id, const string &to_id)
+{
+    Metrics::ScopedTimer timer(shortest_path_seconds);
+    uint32_t source = graph.getIndex(from_id);
+    uint32_t target = graph.getIndex(to_id);
+    if (source == DenseGraph::NoIndex || target == DenseGraph::NoIndex)
+    {
+        return vector<string>();
+    }
+
+    vector<string> path;
+    for (uint32_t index : graph.shortestPath(source, target))
+    {
+        path.push_back(graph.getID(index));
+    }
+    return path;
+}
+
+shared_ptr<const DistanceOracle> ConnectionManager::getDistanceOracle()
+{
+    shared_ptr<const DenseGraph> graph = getDenseGraph();
+    lock_guard<mutex> lock(distance_oracle_mutex);
+    if (!distance_oracle || distance_oracle->getVersion() != graph->getVersion())
+    {
+        MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::DistanceOracle);
+        distance_oracle = distance_oracle ? make_shared<const DistanceOracle>(graph, *distance_oracle)
+                                          : make_shared<const DistanceOracle>(graph);
+    }
+    return distance_oracle;
+}
+
+int ConnectionManager::getDistance(User *from, User *to)
+{
+    return getDistance(*getDistanceOracle(), from->getID(), to->getID());
+}
+
+int ConnectionManager::getDistance(const DistanceOracle &oracle, const string &from_id, const string &to_id)
+{
+    uint32_t source = oracle.getGraph().getIndex(from_id);
+    uint32_t target = oracle.getGraph().getIndex(to_id);
+    if (source == DenseGraph::NoIndex || target == DenseGraph::NoIndex)
+    {
+        return -1;
+    }
+
+    uint32_t hops = oracle.distance(source, target);
+    return hops == DistanceOracle::Unreachable ? -1 : static_cast<int>(hops);
+}
+
+// Static Helper Functions for the graph hash (64-bit FNV-1a)
+static void hashBytes(uint64_t &hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
 }
 
-bool ConnectionManager::isValidConnection(const string &user1_id, const string &user2_id)
+static void hashString(uint64_t &hash, string_view value)
 {
-    // Use the public getConnectionWeight method instead of accessing private matrix directly
-    double weight = adjacency_matrix->getConnectionWeight(user1_id, user2_id);
-    return weight >= 13.0;
+    hashBytes(hash, value.data(), value.size());
+    hashBytes(hash, "\0", 1); // Separator so "ab"+"c" differs from "a"+"bc"
 }
 
-void ConnectionManager::viewConnections(User *user)
+uint64_t ConnectionManager::computeGraphHash() const
 {
-    cout << "Connections for " << user->getName() << ":" << endl;
-    bool hasConnections = false;
+    uint64_t hash = 14695981039346656037ULL;
 
-    // Get all users and check connections with weight threshold
-    for (const auto &other_user : users)
+    uint64_t num_users = users.size();
+    hashBytes(hash, &num_users, sizeof(num_users));
+    for (User *user : users)
     {
-        if (other_user->getID() != user->getID())
-        { // Don't check connection with self
-            double weight = adjacency_matrix->getConnectionWeight(user->getID(), other_user->getID());
+        hashString(hash, user->getID());
+        hashString(hash, user->getCategory());
+        hashString(hash, user->getBranch());
+        double influence = user->getInfluence();
+        hashBytes(hash, &influence, sizeof(influence));
+
+        // Neighbor lists in sorted order so insertion order does not matter
+        vector<string> neighbors;
+        auto it = connections.find(user->getID());
+        if (it != connections.end())
+        {
+            neighbors = it->second;
+        }
+        sort(neighbors.begin(), neighbors.end());
 
-            if (weight >= 13.0)
+        uint64_t degree = neighbors.size();
+        hashBytes(hash, &degree, sizeof(degree));
+        for (const auto &neighbor_id : neighbors)
+        {
+            hashString(hash, neighbor_id);
+        }
+    }
+    return hash;
+}
+
+bool ConnectionManager::saveAnalyticsSnapshot(const string &file_path)
+{
+    Trace::Span span("save analytics snapshot", "io");
+    AnalyticsSnapshot snapshot;
+    snapshot.graph_hash = computeGraphHash();
+
+    // Only results that are current for this graph are written
+    auto toArray = [&](const CachedScores &cache) -> vector<double>
+    {
+        vector<double> values;
+        if (cache.version == graph_version)
+        {
+            values.reserve(users.size());
+            for (User *user : users)
             {
-                cout << other_user->getName()
-                     << " (ID: " << other_user->getID()
-                     << ", Weight: " << weight << ")" << endl;
-                hasConnections = true;
+                auto it = cache.scores.find(user->getID());
+                values.push_back(it != cache.scores.end() ? it->second : 0.0);
             }
         }
-    }
+        return values;
+    };
+    snapshot.betweenness = toArray(cached_betweenness);
+    snapshot.closeness = toArray(cached_closeness);
+    snapshot.pagerank = toArray(cached_pagerank);
 
-    if (!hasConnections)
+    if (communities_version == graph_version)
     {
-        cout << "No valid connections found (weight >= 15.0)." << endl;
+        unordered_map<User *, uint32_t> positions;
+        for (size_t i = 0; i < users.size(); i++)
+        {
+            positions[users[i]] = i;
+        }
+        for (const auto &community : cached_communities)
+        {
+            vector<uint32_t> members;
+            for (User *user : community)
+            {
+                members.push_back(positions[user]);
+            }
+            snapshot.communities.push_back(move(members));
+        }
     }
+
+    return snapshot.saveToFile(file_path);
 }
 
-void ConnectionManager::addUser(User *new_user)
+bool ConnectionManager::loadAnalyticsSnapshot(const string &file_path)
 {
-    // Add user to the adjacency matrix first
-    adjacency_matrix->addNewUser(new_user->getID());
-
-    // Add connections based on category and branch
-    connections[new_user->getID()] = {};
-    vector<vector<User *>> communities = detectCommunities();
+    Trace::Span span("load analytics snapshot", "io");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::AnalyticsCache);
+    AnalyticsSnapshot snapshot;
+    if (!snapshot.loadFromFile(file_path) || snapshot.graph_hash != computeGraphHash())
+    {
+        return false;
+    }
 
-    for (User *user : users)
+    // Parse everything first, so a bad entry leaves every cache untouched
+    auto fromArray = [&](const vector<double> &values, unordered_map<string, double> &scores)
     {
-        if (user != new_user &&
-            user->getCategory() == new_user->getCategory() &&
-            user->getBranch() == new_user->getBranch())
+        if (values.size() != users.size())
         {
+            return false; // Not computed, or for another user list
+        }
+        for (size_t i = 0; i < users.size(); i++)
+        {
+            scores[users[i]->getID()] = values[i];
+        }
+        return true;
+    };
+    unordered_map<string, double> betweenness, closeness, pagerank;
+    bool has_betweenness = fromArray(snapshot.betweenness, betweenness);
+    bool has_closeness = fromArray(snapshot.closeness, closeness);
+    bool has_pagerank = fromArray(snapshot.pagerank, pagerank);
 
-            if (connections[new_user->getID()].size() < 5 &&
-                connections[user->getID()].size() < 5)
+    vector<vector<User *>> communities;
+    for (const auto &members : snapshot.communities)
+    {
+        vector<User *> community;
+        for (uint32_t position : members)
+        {
+            if (position >= users.size())
             {
-
-                connections[new_user->getID()].push_back(user->getID());
-                connections[user->getID()].push_back(new_user->getID());
-
-                // Update the connection weight in the adjacency matrix
-                adjacency_matrix->updateConnection(new_user->getID(), user->getID(), communities);
+                return false;
             }
+            community.push_back(users[position]);
+        }
+        if (!community.empty())
+        {
+            communities.push_back(move(community));
         }
     }
 
-    users.push_back(new_user);
+    // Then install all of it
+    auto install = [&](bool loaded, unordered_map<string, double> &scores, CachedScores &cache)
+    {
+        if (!loaded)
+        {
+            return;
+        }
+        cache.scores = move(scores);
+        cache.version = graph_version;
+        updateLeaderboard(cache);
+    };
+    install(has_betweenness, betweenness, cached_betweenness);
+    install(has_closeness, closeness, cached_closeness);
+    install(has_pagerank, pagerank, cached_pagerank);
+    if (!snapshot.communities.empty())
+    {
+        setCommunities(move(communities));
+    }
+
+    return true;
 }
 
-double ConnectionManager::getConnectionWeight(const string &user1_id, const string &user2_id) const
+unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality()
 {
-    return adjacency_matrix->getConnectionWeight(user1_id, user2_id);
+    return calculateBetweennessCentrality(*getSnapshot());
 }
 
-unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality()
+unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality(const GraphSnapshot &graph)
 {
+    Trace::Span span("betweenness", "analytics");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Betweenness);
+    Metrics::ScopedTimer timer(betweenness_seconds);
+    const vector<string> &user_ids = *graph.user_ids;
     unordered_map<string, double> betweenness;
 
 #pragma omp parallel
     {
+        Trace::Span worker_span("betweenness worker", "analytics");
+        MemoryAccounting::Scope worker_scope(MemoryAccounting::Subsystem::Betweenness);
         unordered_map<string, double> local_betweenness;
 
 #pragma omp for schedule(dynamic)
-        for (size_t i = 0; i < users.size(); i++)
+        for (size_t i = 0; i < user_ids.size(); i++)
         {
-            const auto &user = users[i];
+            const string &user_id = user_ids[i];
             queue<string> queue;
             unordered_map<string, double> distance;
             unordered_map<string, vector<string>> predecessors;
             stack<string> stack;
             unordered_map<string, double> dependency;
 
-            for (const auto &u : users)
+            for (const auto &u : user_ids)
             {
-                distance[u->getID()] = numeric_limits<double>::max();
+                distance[u] = numeric_limits<double>::max();
             }
 
-            distance[user->getID()] = 0;
-            queue.push(user->getID());
+            distance[user_id] = 0;
+            queue.push(user_id);
+            uint64_t edges_examined = 0;
 
             // Forward pass - shortest paths calculation
             while (!queue.empty())
@@ -287,8 +1169,9 @@ unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality(
                 queue.pop();
                 stack.push(curr);
 
-                for (const auto &neighbor_id : connections[curr])
+                for (const auto &neighbor_id : graph.neighbors(curr))
                 {
+                    edges_examined++;
                     if (distance[neighbor_id] == numeric_limits<double>::max())
                     {
                         queue.push(neighbor_id);
@@ -301,6 +1184,9 @@ unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality(
                 }
             }
 
+            bfs_traversals.add();
+            bfs_edges.add(edges_examined);
+
             // Backward pass - dependency accumulation
             while (!stack.empty())
             {
@@ -313,7 +1199,7 @@ unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality(
                     dependency[v] += factor;
                 }
 
-                if (w != user->getID())
+                if (w != user_id)
                 {
                     local_betweenness[w] += dependency[w];
                 }
@@ -334,17 +1220,28 @@ unordered_map<string, double> ConnectionManager::calculateBetweennessCentrality(
 
 unordered_map<string, double> ConnectionManager::calculateClosenessCentrality()
 {
+    return calculateClosenessCentrality(*getSnapshot());
+}
+
+unordered_map<string, double> ConnectionManager::calculateClosenessCentrality(const GraphSnapshot &graph)
+{
+    Trace::Span span("closeness", "analytics");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Closeness);
+    Metrics::ScopedTimer timer(closeness_seconds);
+    const vector<string> &user_ids = *graph.user_ids;
     unordered_map<string, double> closeness;
 
 #pragma omp parallel
     {
+        Trace::Span worker_span("closeness worker", "analytics");
+        MemoryAccounting::Scope worker_scope(MemoryAccounting::Subsystem::Closeness);
         unordered_map<string, double> local_closeness;
 
 #pragma omp for schedule(dynamic)
-        for (size_t i = 0; i < users.size(); i++)
+        for (size_t i = 0; i < user_ids.size(); i++)
         {
-            const auto &user = users[i];
-            auto distances = GraphTraversal::bfsDistance(connections, user->getID());
+            const string &user_id = user_ids[i];
+            auto distances = GraphTraversal::bfsDistance(graph, user_id);
 
             double total_distance = 0.0;
             int reachable_nodes = 0;
@@ -361,11 +1258,11 @@ unordered_map<string, double> ConnectionManager::calculateClosenessCentrality()
             // Normalize by number of reachable nodes
             if (reachable_nodes > 1)
             { // Exclude self from count
-                local_closeness[user->getID()] = (reachable_nodes - 1) / total_distance;
+                local_closeness[user_id] = (reachable_nodes - 1) / total_distance;
             }
             else
             {
-                local_closeness[user->getID()] = 0.0;
+                local_closeness[user_id] = 0.0;
             }
         }
 
@@ -428,86 +1325,111 @@ unordered_map<string, double> ConnectionManager::calculateClosenessCentrality()
 
 unordered_map<string, double> ConnectionManager::calculatePageRank()
 {
-    unordered_map<string, double> pagerank;
-    unordered_map<string, double> out_degree;
-    vector<string> dangling_nodes; // Stores nodes with no outgoing edges
+    return calculatePageRank(*getSnapshot());
+}
+
+unordered_map<string, double> ConnectionManager::calculatePageRank(const GraphSnapshot &graph)
+{
+    Trace::Span span("pagerank", "analytics");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::PageRank);
+    Metrics::ScopedTimer timer(pagerank_seconds);
+    const vector<string> &user_ids = *graph.user_ids;
+    size_t num_users = user_ids.size();
+
+    // Scores live in arrays indexed by position in user_ids, so the parallel loops only write their own slots
+    unordered_map<string, size_t> index_of;
+    index_of.reserve(num_users);
+    for (size_t i = 0; i < num_users; i++)
+    {
+        index_of.emplace(user_ids[i], i);
+    }
 
-    // Initialize pagerank and calculate out-degrees
-    for (const auto &user : users)
+    vector<vector<size_t>> neighbors(num_users);
+    vector<double> out_degree(num_users);
+    vector<size_t> dangling_nodes; // Stores nodes with no outgoing edges
+    for (size_t i = 0; i < num_users; i++)
     {
-        string user_id = user->getID();
-        pagerank[user_id] = 1.0 / users.size();
-        out_degree[user_id] = connections[user_id].size();
+        for (const auto &neighbor_id : graph.neighbors(user_ids[i]))
+        {
+            auto it = index_of.find(neighbor_id);
+            if (it != index_of.end())
+            {
+                neighbors[i].push_back(it->second);
+            }
+        }
+        out_degree[i] = graph.neighbors(user_ids[i]).size();
 
-        if (out_degree[user_id] == 0)
+        if (out_degree[i] == 0)
         {
-            dangling_nodes.push_back(user_id); // Mark dangling nodes
+            dangling_nodes.push_back(i); // Mark dangling nodes
         }
     }
 
+    vector<double> pagerank(num_users, 1.0 / num_users);
+    vector<double> new_pagerank(num_users);
+
     double damping_factor = 0.85;
     double tolerance = 1e-4;      // Start with a larger tolerance for faster initial iterations
     double min_tolerance = 1e-6;  // Minimum tolerance to tighten as convergence improves
     double tolerance_decay = 0.9; // Factor to reduce tolerance per iteration
-    bool converged = false;
+    bool converged = num_users == 0;
 
     while (!converged)
     {
-        unordered_map<string, double> new_pagerank;
         double total_pagerank = 0.0;
         double dangling_sum = 0.0; // Contribution from dangling nodes
 
         // Sum contributions from dangling nodes
-        for (const auto &dangling_id : dangling_nodes)
+        for (size_t dangling : dangling_nodes)
         {
-            dangling_sum += pagerank[dangling_id];
+            dangling_sum += pagerank[dangling];
         }
-        dangling_sum *= damping_factor / users.size();
+        dangling_sum *= damping_factor / num_users;
 
 // Parallelize the computation of new pagerank values
 #pragma omp parallel for reduction(+ : total_pagerank)
-        for (size_t i = 0; i < users.size(); ++i)
+        for (size_t i = 0; i < num_users; ++i)
         {
-            User *user = users[i];
-            string user_id = user->getID();
             double sum = 0.0;
 
             // Sum up the contributions from neighbors
-            for (const auto &neighbor_id : connections[user_id])
+            for (size_t neighbor : neighbors[i])
             {
-                sum += pagerank[neighbor_id] / out_degree[neighbor_id];
+                sum += pagerank[neighbor] / out_degree[neighbor];
             }
 
             // Calculate new PageRank for the current user, including dangling node contribution
-            new_pagerank[user_id] = (1.0 - damping_factor) / users.size() + damping_factor * sum + dangling_sum;
-            total_pagerank += new_pagerank[user_id];
+            new_pagerank[i] = (1.0 - damping_factor) / num_users + damping_factor * sum + dangling_sum;
+            total_pagerank += new_pagerank[i];
         }
 
         // Normalize new PageRank values and check for convergence
         converged = true;
-#pragma omp parallel for
-        for (size_t i = 0; i < users.size(); ++i)
+#pragma omp parallel for reduction(&& : converged)
+        for (size_t i = 0; i < num_users; ++i)
         {
-            User *user = users[i];
-            string user_id = user->getID();
-
-            new_pagerank[user_id] /= total_pagerank;
+            new_pagerank[i] /= total_pagerank;
 
             // Check convergence
-            if (fabs(new_pagerank[user_id] - pagerank[user_id]) > tolerance)
+            if (fabs(new_pagerank[i] - pagerank[i]) > tolerance)
             {
-#pragma omp atomic write
                 converged = false;
             }
         }
 
-        pagerank = move(new_pagerank);
+        swap(pagerank, new_pagerank);
 
         // Tighten the tolerance for the next iteration if not yet at min_tolerance
         tolerance = max(min_tolerance, tolerance * tolerance_decay);
     }
 
-    return pagerank;
+    unordered_map<string, double> scores;
+    scores.reserve(num_users);
+    for (size_t i = 0; i < num_users; i++)
+    {
+        scores[user_ids[i]] = pagerank[i];
+    }
+    return scores;
 }
 
 // vector<vector<User *>> ConnectionManager::detectCommunities()
@@ -584,28 +1506,40 @@ unordered_map<string, double> ConnectionManager::calculatePageRank()
 
 vector<vector<User *>> ConnectionManager::detectCommunities()
 {
+    Trace::Span span("detect communities", "analytics");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Communities);
+    Metrics::ScopedTimer timer(detect_communities_seconds);
     const int TARGET_COMMUNITY_SIZE = users.size() / 10;       // Aim for roughly 10 communities
     const int MAX_COMMUNITY_SIZE = floor(users.size() * 0.14); // Allow some flexibility
 
     vector<vector<User *>> communityGroups;
     unordered_map<string, int> communities; // maps user ID to community ID
 
-    // Sort users by branch and category to help initial grouping
-    vector<User *> sortedUsers = users;
-    sort(sortedUsers.begin(), sortedUsers.end(),
-         [](const User *a, const User *b)
-         {
-             if (a->getBranch() != b->getBranch())
-                 return a->getBranch() < b->getBranch();
-             return a->getCategory() < b->getCategory();
-         });
+    // Group users by branch and category to help initial grouping
+    // (bucketed by dictionary code, so no string comparisons are needed)
+    size_t num_categories = user_store.getCategoryDictionary().size();
+    size_t num_branches = user_store.getBranchDictionary().size();
+    vector<vector<User *>> attributeBuckets(num_branches * num_categories);
+    for (User *user : users)
+    {
+        attributeBuckets[user->getBranchCode() * num_categories + user->getCategoryCode()].push_back(user);
+    }
+
+    vector<User *> sortedUsers;
+    sortedUsers.reserve(users.size());
+    for (const auto &bucket : attributeBuckets)
+    {
+        sortedUsers.insert(sortedUsers.end(), bucket.begin(), bucket.end());
+    }
 
     // Initial assignment based on similar attributes
     int currentCommunity = 0;
     vector<User *> currentGroup;
 
-    random_device rd;
-    mt19937 gen(rd());
+    // Fixed seed: the attribute-based split then only changes when users do, so an
+    // edge edit moves just the users refinement reassigns (a graph-hash seed would
+    // reshuffle every boundary on each edit and relabel most of the network)
+    mt19937 gen(CommunitySeed);
     uniform_int_distribution<> dis(static_cast<int>(MAX_COMMUNITY_SIZE) - 4, static_cast<int>(MAX_COMMUNITY_SIZE) + 4);
 
     for (User *user : sortedUsers)
@@ -642,8 +1576,15 @@ vector<vector<User *>> ConnectionManager::detectCommunities()
             int currentComm = communities[user->getID()];
             unordered_map<int, int> neighborCommunities;
 
+            // Reached from read-locked paths, so look up without inserting
+            auto neighbors = connections.find(user->getID());
+            if (neighbors == connections.end() || neighbors->second.empty())
+            {
+                continue;
+            }
+
             // Count neighbor communities
-            for (const string &neighborId : connections[user->getID()])
+            for (const string &neighborId : neighbors->second)
             {
                 neighborCommunities[communities[neighborId]]++;
             }
@@ -659,7 +1600,7 @@ vector<vector<User *>> ConnectionManager::detectCommunities()
                 // 2. Current size of that community (prefer smaller communities)
                 double communitySize = communityGroups[pair.first].size();
                 double sizeScore = 1.0 - (communitySize / MAX_COMMUNITY_SIZE);
-                double connectionScore = pair.second / (double)connections[user->getID()].size();
+                double connectionScore = pair.second / (double)neighbors->second.size();
                 double score = connectionScore * 0.7 + sizeScore * 0.3; // Weight factors
 
                 if (score > bestScore && communityGroups[pair.first].size() < MAX_COMMUNITY_SIZE)
@@ -697,6 +1638,89 @@ vector<vector<User *>> ConnectionManager::detectCommunities()
     return communityGroups;
 }
 
+int ConnectionManager::getCommunityIndex(const string &user_id) const
+{
+    auto it = community_index.find(user_id);
+    return it != community_index.end() ? it->second : -1;
+}
+
+const vector<vector<User *>> &ConnectionManager::getCommunities()
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Communities);
+    lock_guard<mutex> lock(communities_mutex);
+    if (communities_version == graph_version)
+    {
+        return cached_communities;
+    }
+
+    setCommunities(detectCommunities());
+    return cached_communities;
+}
+
+void ConnectionManager::setCommunities(vector<vector<User *>> communities)
+{
+    cached_communities = move(communities);
+    communities_version = graph_version;
+
+    // Label each community by its smallest member ID so labels survive reordering
+    unordered_map<string, string> new_labels;
+    for (const auto &community : cached_communities)
+    {
+        string label = community.front()->getID();
+        for (User *user : community)
+        {
+            label = min(label, user->getID());
+        }
+        for (User *user : community)
+        {
+            new_labels[user->getID()] = label;
+        }
+    }
+
+    // A user changing community affects everyone in both the old and the new one
+    unordered_set<string> affected_labels;
+    for (const auto &entry : new_labels)
+    {
+        auto old_label = community_labels.find(entry.first);
+        if (old_label == community_labels.end())
+        {
+            affected_labels.insert(entry.second);
+        }
+        else if (old_label->second != entry.second)
+        {
+            affected_labels.insert(old_label->second);
+            affected_labels.insert(entry.second);
+        }
+    }
+
+    if (!affected_labels.empty())
+    {
+        for (const auto *labels : {&community_labels, &new_labels})
+        {
+            for (const auto &entry : *labels)
+            {
+                if (affected_labels.count(entry.second))
+                {
+                    RecommendationShard &shard = getRecommendationShard(entry.first);
+                    lock_guard<mutex> lock(shard.lock);
+                    shard.entries.erase(entry.first);
+                }
+            }
+        }
+    }
+
+    community_labels = move(new_labels);
+
+    community_index.clear();
+    for (size_t i = 0; i < cached_communities.size(); ++i)
+    {
+        for (User *user : cached_communities[i])
+        {
+            community_index[user->getID()] = i;
+        }
+    }
+}
+
 vector<User *> ConnectionManager::getAllUsers()
 {
     return users; // Assuming 'users' is a vector that stores all User pointers
@@ -743,81 +1767,141 @@ vector<User *> ConnectionManager::getAllUsers()
 //     return recommendations;
 // }
 
-vector<pair<User *, User *>> ConnectionManager::recommendConnectionsForNewUser(User *new_user)
+// Helper function to get user attributes as a set
+static unordered_set<string> getUserAttributes(User *user)
 {
-    vector<pair<User *, User *>> recommendations;
-    unordered_map<string, int> community_map;
-    vector<vector<User *>> communities = detectCommunities();
+    unordered_set<string> attributes;
+
+    // Add available user attributes
+    attributes.emplace(user->getCategory());
+    attributes.emplace(user->getBranch());
+    attributes.emplace(user->getName());
+
+    // Convert influence to a discretized string representation
+    // This helps include influence in similarity calculation
+    int influence_level = static_cast<int>(user->getInfluence() * 10);
+    attributes.insert("influence_" + to_string(influence_level));
+
+    return attributes;
+}
 
-    // Map users to their communities
-    for (int i = 0; i < communities.size(); ++i)
+// Calculate Jaccard similarity between two sets
+static double calculateJaccardSimilarity(const unordered_set<string> &set1,
+                                         const unordered_set<string> &set2)
+{
+    if (set1.empty() && set2.empty())
+        return 0.0;
+
+    size_t intersection_size = 0;
+    for (const auto &elem : set1)
     {
-        for (User *user : communities[i])
+        if (set2.find(elem) != set2.end())
         {
-            community_map[user->getID()] = i;
+            intersection_size++;
         }
     }
 
-    // Helper function to get user attributes as a set
-    auto getUserAttributes = [](User *user) -> unordered_set<string>
+    size_t union_size = set1.size() + set2.size() - intersection_size;
+    return static_cast<double>(intersection_size) / union_size;
+}
+
+vector<pair<User *, User *>> ConnectionManager::recommendConnectionsForNewUser(User *new_user)
+{
+    Trace::Span span("recommend", "request");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Recommendations);
+    Metrics::ScopedTimer timer(recommend_seconds);
+
+    // Refresh communities first, this may invalidate cached entries
+    getCommunities();
+
+    RecommendationShard &shard = getRecommendationShard(new_user->getID());
     {
-        unordered_set<string> attributes;
+        lock_guard<mutex> lock(shard.lock);
+        auto cached = shard.entries.find(new_user->getID());
+        if (cached != shard.entries.end())
+        {
+            recommendation_cache_hits.add();
+            return cached->second;
+        }
+    }
+    recommendation_cache_misses.add();
 
-        // Add available user attributes
-        attributes.insert(user->getCategory());
-        attributes.insert(user->getBranch());
-        attributes.insert(user->getName());
+    // Structural signal from the friends-of-friends neighborhood
+    vector<LinkPredictor::LinkScore> link_scores = getLinkPredictor()->predict(new_user->getID());
 
-        // Convert influence to a discretized string representation
-        // This helps include influence in similarity calculation
-        int influence_level = static_cast<int>(user->getInfluence() * 10);
-        attributes.insert("influence_" + to_string(influence_level));
+    vector<pair<User *, User *>> recommendations;
+    for (const auto &ranked : rankRecommendations(new_user, link_scores, 0, nullptr))
+    {
+        recommendations.emplace_back(new_user, ranked.second);
+    }
 
-        return attributes;
-    };
+    // Ranked without the shard lock; a concurrent session for the same user stores the same list
+    lock_guard<mutex> lock(shard.lock);
+    shard.entries[new_user->getID()] = recommendations;
+    return recommendations;
+}
 
-    // Calculate Jaccard similarity between two sets
-    auto calculateJaccardSimilarity = [](const unordered_set<string> &set1,
-                                         const unordered_set<string> &set2) -> double
+vector<pair<double, User *>> ConnectionManager::rankRecommendations(User *new_user,
+                                                                   const vector<LinkPredictor::LinkScore> &link_scores,
+                                                                   size_t top_k,
+                                                                   const unordered_map<string, unordered_set<string>> *attribute_cache) const
+{
+    unordered_map<string, double> structural_scores;
+    double max_adamic_adar = link_scores.empty() ? 0.0 : link_scores.front().adamic_adar; // Sorted descending
+    for (const auto &score : link_scores)
     {
-        if (set1.empty() && set2.empty())
-            return 0.0;
+        // Blend normalized Adamic-Adar with neighborhood Jaccard (0 to 1 scale)
+        double normalized_aa = max_adamic_adar > 0 ? score.adamic_adar / max_adamic_adar : 0.0;
+        structural_scores[score.candidate_id] = normalized_aa * 0.7 + score.jaccard * 0.3;
+    }
 
-        size_t intersection_size = 0;
-        for (const auto &elem : set1)
+    // Attribute sets come from the shared cache in batch mode (by reference, no copy),
+    // otherwise they are computed into the caller's local, which must outlive the result
+    auto getAttributes = [&](User *user, unordered_set<string> &computed) -> const unordered_set<string> &
+    {
+        if (attribute_cache)
         {
-            if (set2.find(elem) != set2.end())
+            auto it = attribute_cache->find(user->getID());
+            if (it != attribute_cache->end())
             {
-                intersection_size++;
+                return it->second;
             }
         }
+        computed = getUserAttributes(user);
+        return computed;
+    };
 
-        size_t union_size = set1.size() + set2.size() - intersection_size;
-        return static_cast<double>(intersection_size) / union_size;
+    auto getCommunity = [&](User *user) -> int
+    {
+        return getCommunityIndex(user->getID());
     };
 
-    vector<pair<double, pair<User *, User *>>> sortedRecommendations;
-    unordered_set<string> new_user_attributes = getUserAttributes(new_user);
+    vector<pair<double, User *>> sortedRecommendations;
+    unordered_set<string> new_user_computed;
+    const unordered_set<string> &new_user_attributes = getAttributes(new_user, new_user_computed);
+    int new_user_community = getCommunity(new_user);
 
-    // Calculate similarity scores for all users in different communities
-    for (User *user : users)
+    // Calculate the similarity score for one candidate in a different community
+    auto scoreCandidate = [&](User *user)
     {
         // Skip if same user or already connected
         if (user == new_user)
         {
-            continue;
+            return;
         }
 
         // Check existing connections using adjacency matrix
         double connection_weight = getConnectionWeight(new_user->getID(), user->getID());
         if (connection_weight != 0)
         {
-            continue;
+            return;
         }
 
-        if (community_map[user->getID()] != community_map[new_user->getID()])
+        int user_community = getCommunity(user);
+        if (user_community != new_user_community)
         {
-            unordered_set<string> user_attributes = getUserAttributes(user);
+            unordered_set<string> user_computed;
+            const unordered_set<string> &user_attributes = getAttributes(user, user_computed);
 
             // Calculate Jaccard similarity
             double jaccard_score = calculateJaccardSimilarity(new_user_attributes, user_attributes);
@@ -831,42 +1915,191 @@ vector<pair<User *, User *>> ConnectionManager::recommendConnectionsForNewUser(U
                                  influence_similarity * 0.2; // Influence similarity
 
             // Add bonus for exact matches on important attributes
-            if (user->getCategory() == new_user->getCategory())
+            if (user->getCategoryCode() == new_user->getCategoryCode())
             {
                 final_score += 0.1;
             }
-            if (user->getBranch() == new_user->getBranch())
+            if (user->getBranchCode() == new_user->getBranchCode())
             {
                 final_score += 0.1;
             }
-            if (community_map[user->getID()] == community_map[new_user->getID()])
+            if (user_community == new_user_community)
             {
                 final_score += 0.3;
             }
 
+            // Bonus for users reachable through mutual connections
+            auto structural = structural_scores.find(user->getID());
+            if (structural != structural_scores.end())
+            {
+                final_score += structural->second * 0.3;
+            }
+
             // Use negative score for sorting in descending order
-            sortedRecommendations.emplace_back(-final_score, make_pair(new_user, user));
+            sortedRecommendations.emplace_back(-final_score, user);
+        }
+    };
+
+    // Candidate generation: LSH bucket collisions plus friends-of-friends
+    unordered_set<string> candidate_ids;
+    for (const auto &candidate_id : similarity_index.query(new_user->getID(), MaxLshCandidates))
+    {
+        candidate_ids.insert(candidate_id);
+    }
+    for (const auto &score : link_scores)
+    {
+        candidate_ids.insert(score.candidate_id);
+    }
+    for (const auto &candidate_id : candidate_ids)
+    {
+        User *candidate = getUser(candidate_id);
+        if (candidate)
+        {
+            scoreCandidate(candidate);
+        }
+    }
+
+    // Too few usable candidates (sparse profile or tiny network): scan the rest as well
+    if (sortedRecommendations.size() < MinLshCandidates)
+    {
+        for (User *user : users)
+        {
+            if (candidate_ids.find(user->getID()) == candidate_ids.end())
+            {
+                scoreCandidate(user);
+            }
         }
     }
 
     // Sort recommendations by similarity score
-    sort(sortedRecommendations.begin(), sortedRecommendations.end());
+    if (top_k > 0 && sortedRecommendations.size() > top_k)
+    {
+        partial_sort(sortedRecommendations.begin(), sortedRecommendations.begin() + top_k, sortedRecommendations.end());
+        sortedRecommendations.resize(top_k);
+    }
+    else
+    {
+        sort(sortedRecommendations.begin(), sortedRecommendations.end());
+    }
 
-    // Extract final recommendations
-    for (const auto &pair : sortedRecommendations)
+    // Flip scores back to positive
+    for (auto &entry : sortedRecommendations)
     {
-        recommendations.emplace_back(pair.second);
+        entry.first = -entry.first;
     }
+    return sortedRecommendations;
+}
 
-    return recommendations;
+size_t ConnectionManager::writeRecommendationsForAllUsers(const string &output_file, size_t top_k)
+{
+    Trace::Span span("batch recommendations", "analytics");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Recommendations);
+    // Shared precomputation: community map, attribute sets and the structural index
+    getCommunities();
+
+    unordered_map<string, unordered_set<string>> attribute_cache;
+    for (User *user : users)
+    {
+        attribute_cache[user->getID()] = getUserAttributes(user);
+    }
+
+    shared_ptr<const LinkPredictor> link_predictor = getLinkPredictor();
+    vector<vector<pair<double, User *>>> results(users.size());
+
+#pragma omp parallel
+    {
+        Trace::Span worker_span("recommendation worker", "analytics");
+        MemoryAccounting::Scope worker_scope(MemoryAccounting::Subsystem::Recommendations);
+        LinkPredictor::Scratch scratch;
+
+#pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < users.size(); i++)
+        {
+            vector<LinkPredictor::LinkScore> link_scores = link_predictor->predict(users[i]->getID(), 0, scratch);
+            results[i] = rankRecommendations(users[i], link_scores, top_k, &attribute_cache);
+        }
+    }
+
+    ofstream file(output_file);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open recommendations file for writing." << endl;
+        return 0;
+    }
+
+    // One line per user: user_id,recommended_id recommended_id ...
+    file << "user_id,recommendations\n";
+    for (size_t i = 0; i < users.size(); i++)
+    {
+        file << users[i]->getID() << ",";
+        for (size_t j = 0; j < results[i].size(); j++)
+        {
+            if (j > 0)
+                file << " ";
+            file << results[i][j].second->getID();
+        }
+        file << "\n";
+    }
+
+    file.close();
+    return users.size();
+}
+
+// Static Helper Functions for rendering
+// Each connection once (lower matrix index first), weighted from the matrix, so
+// rendering costs O(V + E) instead of a scan of the whole matrix
+static vector<GraphVisualizer::Edge> weightedConnections(const unordered_map<string, vector<string>> &connections,
+                                                         const AdjacencyMatrix &matrix)
+{
+    const unordered_map<string, int> &index_of = matrix.getUserIndexMap();
+    const vector<vector<double>> &weights = matrix.getMatrix();
+
+    vector<GraphVisualizer::Edge> edges;
+    for (const auto &entry : connections)
+    {
+        auto from = index_of.find(entry.first);
+        if (from == index_of.end())
+        {
+            continue;
+        }
+        for (const string &neighbor_id : entry.second)
+        {
+            auto to = index_of.find(neighbor_id);
+            if (to != index_of.end() && from->second < to->second)
+            {
+                edges.push_back({static_cast<size_t>(from->second), static_cast<size_t>(to->second),
+                                 weights[from->second][to->second]});
+            }
+        }
+    }
+    sort(edges.begin(), edges.end(), [](const GraphVisualizer::Edge &a, const GraphVisualizer::Edge &b)
+         { return make_pair(a.from, a.to) < make_pair(b.from, b.to); }); // Stable output across runs
+    edges.erase(unique(edges.begin(), edges.end(), [](const GraphVisualizer::Edge &a, const GraphVisualizer::Edge &b)
+                       { return a.from == b.from && a.to == b.to; }),
+                edges.end());
+    return edges;
 }
 
 void ConnectionManager::visualizeGraph(const string &output_file,
-                                       const unordered_map<string, double> &betweenness,
                                        const vector<vector<User *>> &communities)
 {
     GraphVisualizer visualizer(15.0);
-    visualizer.createGraph("adjacency_matrix.csv", communities, output_file);
+    vector<GraphVisualizer::Edge> edges = weightedConnections(connections, *adjacency_matrix);
+
+    // .svg is laid out natively, anything else goes through Graphviz
+    if (output_file.size() >= 4 && output_file.compare(output_file.size() - 4, 4, ".svg") == 0)
+    {
+        visualizer.createSvg(adjacency_matrix->getUserIds(), edges, communities, output_file);
+        return;
+    }
+    visualizer.createGraph(adjacency_matrix->getUserIds(), edges, communities, output_file);
+}
+
+void ConnectionManager::visualizeCommunities(const string &output_file, const unordered_set<int> &expanded_communities)
+{
+    GraphVisualizer visualizer(15.0);
+    visualizer.createCommunityOverview(adjacency_matrix->getUserIds(), weightedConnections(connections, *adjacency_matrix),
+                                       getCommunities(), expanded_communities, output_file);
 }
 
 int ConnectionManager::getRandomPosition(int max)
@@ -879,18 +2112,14 @@ double ConnectionManager::getLuminance(const string &color)
 
 User *ConnectionManager::getUser(const string &id) const
 {
-    for (User *user : users)
-    {
-        if (user->getID() == id)
-        {
-            return user;
-        }
-    }
-    return nullptr;
+    auto it = user_lookup.find(id);
+    return it != user_lookup.end() ? it->second : nullptr;
 }
 
 void ConnectionManager::loadUserData(const string &file_path)
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Users);
+    Trace::Span span("load users", "startup");
     ifstream file(file_path);
     string line;
     getline(file, line); // Skip header row
@@ -908,18 +2137,19 @@ void ConnectionManager::loadUserData(const string &file_path)
         ss.ignore();
         getline(ss, branch, ',');
 
-        users.push_back(new User(name, id, password, category, influence, branch));
+        users.push_back(user_store.addUser(name, id, password, category, influence, branch));
+        user_lookup.emplace(id, users.back());
     }
 }
 
 void ConnectionManager::establishConnections()
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Connections);
+    Trace::Span span("generate connections", "startup");
     random_device rd;
     mt19937 gen(rd());
     uniform_real_distribution<> dis(0.0, 1.0);
 
-    vector<vector<User *>> communities = detectCommunities();
-
     // Only establish connections for the first InitialNum users
     for (int i = 0; i < min(InitialNum, (int)users.size()); i++)
     {
@@ -930,8 +2160,8 @@ void ConnectionManager::establishConnections()
             if (user1 != user2)
             {
                 double connection_probability =
-                    (user1->getCategory() == user2->getCategory() &&
-                     user1->getBranch() == user2->getBranch())
+                    (user1->getCategoryCode() == user2->getCategoryCode() &&
+                     user1->getBranchCode() == user2->getBranchCode())
                         ? 0.5
                         : 0.2;
 
@@ -946,6 +2176,10 @@ void ConnectionManager::establishConnections()
             }
         }
     }
+
+    clearRecommendations();
+    snapshot.reset(); // Every neighbor block changed
+    graph_version++;
 }
 
 void ConnectionManager::saveUserData(const string &file_path)
@@ -0,0 +1,152 @@
+#include "dense_graph.h"
+#include <bits/stdc++.h>
+#include "metrics.h"
+
+using namespace std;
+
+// Metrics (shared with the traversals in ConnectionManager)
+static const Metrics::Counter bfs_traversals = Metrics::counter("cm_bfs_traversals_total", "Breadth-first searches run by the analytics");
+static const Metrics::Counter bfs_edges = Metrics::counter("cm_bfs_edges_total", "Edges examined by breadth-first searches");
+
+// Per-thread search state, reused across queries. An entry belongs to the
+// current query only when its stamp matches, so nothing is cleared between
+// queries and a query costs only what it visits.
+struct PathSearchState
+{
+    uint32_t stamp = 0;
+    vector<uint32_t> visited[2]; // Stamp of the query that reached the node, per direction
+    vector<uint32_t> parent[2];  // Previous node towards the source (0) or the target (1)
+    vector<uint32_t> depth[2];
+
+    void begin(size_t num_nodes)
+    {
+        if (visited[0].size() < num_nodes || ++stamp == 0)
+        {
+            for (int side = 0; side < 2; side++)
+            {
+                visited[side].assign(max(num_nodes, visited[side].size()), 0);
+                parent[side].resize(visited[side].size());
+                depth[side].resize(visited[side].size());
+            }
+            stamp = 1;
+        }
+    }
+};
+
+DenseGraph::DenseGraph(const GraphSnapshot &graph) : version(graph.version), user_ids(graph.user_ids)
+{
+    const vector<string> &ids = *user_ids;
+    index_of.reserve(ids.size());
+    for (uint32_t i = 0; i < ids.size(); i++)
+    {
+        index_of.emplace(ids[i], i);
+    }
+
+    offsets.reserve(ids.size() + 1);
+    offsets.push_back(0);
+    for (const string &user_id : ids)
+    {
+        for (const string &neighbor_id : graph.neighbors(user_id))
+        {
+            auto it = index_of.find(neighbor_id);
+            if (it != index_of.end())
+            {
+                targets.push_back(it->second);
+            }
+        }
+        offsets.push_back(targets.size());
+    }
+}
+
+uint32_t DenseGraph::getIndex(const string &user_id) const
+{
+    auto it = index_of.find(user_id);
+    return it != index_of.end() ? it->second : NoIndex;
+}
+
+vector<uint32_t> DenseGraph::shortestPath(uint32_t source, uint32_t target) const
+{
+    if (source == target)
+    {
+        return {source};
+    }
+
+    thread_local PathSearchState state;
+    state.begin(size());
+    const uint32_t stamp = state.stamp;
+
+    vector<uint32_t> frontier[2] = {{source}, {target}};
+    for (int side = 0; side < 2; side++)
+    {
+        uint32_t start = frontier[side][0];
+        state.visited[side][start] = stamp;
+        state.parent[side][start] = NoIndex;
+        state.depth[side][start] = 0;
+    }
+
+    // Best meeting edge so far: near is reached from its side, far from the other
+    uint32_t best_length = NoIndex, near = NoIndex, far = NoIndex;
+    int near_side = 0;
+    uint64_t edges_examined = 0;
+
+    while (!frontier[0].empty() && !frontier[1].empty() && best_length == NoIndex)
+    {
+        int side = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        int other = 1 - side;
+        vector<uint32_t> next;
+
+        // The whole level is expanded so the shortest of its meetings wins
+        for (uint32_t node : frontier[side])
+        {
+            for (const uint32_t *it = neighborsBegin(node); it != neighborsEnd(node); ++it)
+            {
+                uint32_t neighbor = *it;
+                edges_examined++;
+
+                if (state.visited[other][neighbor] == stamp)
+                {
+                    uint32_t length = state.depth[side][node] + 1 + state.depth[other][neighbor];
+                    if (length < best_length)
+                    {
+                        best_length = length;
+                        near = node;
+                        far = neighbor;
+                        near_side = side;
+                    }
+                }
+                if (state.visited[side][neighbor] != stamp)
+                {
+                    state.visited[side][neighbor] = stamp;
+                    state.parent[side][neighbor] = node;
+                    state.depth[side][neighbor] = state.depth[side][node] + 1;
+                    next.push_back(neighbor);
+                }
+            }
+        }
+        frontier[side] = move(next);
+    }
+
+    bfs_traversals.add();
+    bfs_edges.add(edges_examined);
+
+    if (best_length == NoIndex)
+    {
+        return vector<uint32_t>();
+    }
+
+    // Walk back to the source from the source-side end, then on to the target
+    uint32_t source_end = near_side == 0 ? near : far;
+    uint32_t target_end = near_side == 0 ? far : near;
+
+    vector<uint32_t> path;
+    for (uint32_t node = source_end; node != NoIndex; node = state.parent[0][node])
+    {
+        path.push_back(node);
+    }
+    reverse(path.begin(), path.end());
+    for (uint32_t node = target_end; node != NoIndex; node = state.parent[1][node])
+    {
+        path.push_back(node);
+    }
+    return path;
+}
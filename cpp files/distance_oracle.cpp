@@ -0,0 +1,324 @@
+#include "distance_oracle.h"
+#include <bits/stdc++.h>
+#include "metrics.h"
+#include "trace.h"
+
+using namespace std;
+
+// Metrics
+static const Metrics::Histogram full_build_seconds = Metrics::histogram("oracle_full_build_seconds", "Full distance oracle builds");
+static const Metrics::Histogram incremental_update_seconds = Metrics::histogram("oracle_incremental_update_seconds", "Distance oracle updates for added edges");
+
+// Static Helper Functions
+static vector<uint32_t> sortedNeighbors(const DenseGraph &graph, uint32_t index)
+{
+    vector<uint32_t> neighbors(graph.neighborsBegin(index), graph.neighborsEnd(index));
+    sort(neighbors.begin(), neighbors.end());
+    return neighbors;
+}
+
+DistanceOracle::DistanceOracle(shared_ptr<const DenseGraph> graph) : graph(move(graph))
+{
+    build();
+}
+
+DistanceOracle::DistanceOracle(shared_ptr<const DenseGraph> graph, const DistanceOracle &previous) : graph(move(graph))
+{
+    if (!update(previous))
+    {
+        build();
+    }
+}
+
+void DistanceOracle::build()
+{
+    Trace::Span span("distance oracle build", "analytics");
+    Metrics::ScopedTimer timer(full_build_seconds);
+    size_t num_vertices = graph->size();
+
+    // Landmarks in decreasing degree, so early searches cover the most paths
+    vertex_of_rank.resize(num_vertices);
+    iota(vertex_of_rank.begin(), vertex_of_rank.end(), 0);
+    stable_sort(vertex_of_rank.begin(), vertex_of_rank.end(), [&](uint32_t a, uint32_t b)
+                { return graph->degree(a) > graph->degree(b); });
+
+    vector<vector<LabelEntry>> labels(num_vertices);
+    vector<uint32_t> distance(num_vertices, Unreachable);
+    vector<uint32_t> root_distance(num_vertices, Unreachable); // Root's label, by rank
+    vector<uint32_t> queue;
+    queue.reserve(num_vertices);
+
+    for (uint32_t rank = 0; rank < num_vertices; rank++)
+    {
+        uint32_t root = vertex_of_rank[rank];
+        for (const LabelEntry &entry : labels[root])
+        {
+            root_distance[entry.rank] = entry.distance;
+        }
+
+        queue.clear();
+        queue.push_back(root);
+        distance[root] = 0;
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            uint32_t node = queue[head];
+
+            // Pruned: an earlier landmark already gives a path this short
+            bool covered = false;
+            for (const LabelEntry &entry : labels[node])
+            {
+                if (root_distance[entry.rank] != Unreachable &&
+                    root_distance[entry.rank] + entry.distance <= distance[node])
+                {
+                    covered = true;
+                    break;
+                }
+            }
+            if (covered)
+            {
+                continue;
+            }
+
+            labels[node].push_back({rank, distance[node]});
+            for (const uint32_t *it = graph->neighborsBegin(node); it != graph->neighborsEnd(node); ++it)
+            {
+                if (distance[*it] == Unreachable)
+                {
+                    distance[*it] = distance[node] + 1;
+                    queue.push_back(*it);
+                }
+            }
+        }
+
+        for (uint32_t node : queue)
+        {
+            distance[node] = Unreachable;
+        }
+        for (const LabelEntry &entry : labels[root])
+        {
+            root_distance[entry.rank] = Unreachable;
+        }
+    }
+    setLabels(labels);
+}
+
+bool DistanceOracle::update(const DistanceOracle &previous)
+{
+    const DenseGraph &old_graph = previous.getGraph();
+    size_t old_size = old_graph.size();
+    size_t num_vertices = graph->size();
+    if (num_vertices < old_size)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < old_size; i++)
+    {
+        if (graph->getID(i) != old_graph.getID(i))
+        {
+            return false; // Users were reordered, the labels no longer line up
+        }
+    }
+
+    // Added edges (each once, from its lower endpoint); any removal forces a rebuild
+    vector<pair<uint32_t, uint32_t>> added_edges;
+    for (uint32_t node = 0; node < num_vertices; node++)
+    {
+        if (node < old_size && old_graph.degree(node) == graph->degree(node) &&
+            equal(graph->neighborsBegin(node), graph->neighborsEnd(node), old_graph.neighborsBegin(node)))
+        {
+            continue;
+        }
+
+        vector<uint32_t> now = sortedNeighbors(*graph, node);
+        vector<uint32_t> before = node < old_size ? sortedNeighbors(old_graph, node) : vector<uint32_t>();
+        if (!includes(now.begin(), now.end(), before.begin(), before.end()))
+        {
+            return false;
+        }
+
+        vector<uint32_t> gained;
+        set_difference(now.begin(), now.end(), before.begin(), before.end(), back_inserter(gained));
+        for (uint32_t neighbor : gained)
+        {
+            if (node < neighbor)
+            {
+                added_edges.emplace_back(node, neighbor);
+            }
+        }
+        if (added_edges.size() > MaxIncrementalEdges)
+        {
+            return false;
+        }
+    }
+
+    Trace::Span span("distance oracle update", "analytics");
+    Metrics::ScopedTimer timer(incremental_update_seconds);
+    vertex_of_rank = previous.vertex_of_rank;
+    vector<vector<LabelEntry>> labels = previous.getLabels();
+
+    // New users rank last and start out labeled only by themselves
+    labels.resize(num_vertices);
+    for (uint32_t node = old_size; node < num_vertices; node++)
+    {
+        labels[node].push_back({static_cast<uint32_t>(vertex_of_rank.size()), 0});
+        vertex_of_rank.push_back(node);
+    }
+
+    vector<uint32_t> root_distance(num_vertices, Unreachable);
+    vector<bool> queued(num_vertices, false);
+    for (const auto &edge : added_edges)
+    {
+        // Landmarks that reach one endpoint may now reach further through the other
+        vector<LabelEntry> first_label = labels[edge.first];
+        vector<LabelEntry> second_label = labels[edge.second];
+        for (const LabelEntry &entry : first_label)
+        {
+            resumeSearch(labels, entry.rank, edge.second, entry.distance + 1, root_distance, queued);
+        }
+        for (const LabelEntry &entry : second_label)
+        {
+            resumeSearch(labels, entry.rank, edge.first, entry.distance + 1, root_distance, queued);
+        }
+    }
+    setLabels(labels);
+    return true;
+}
+
+// Continues a landmark's pruned BFS from a vertex it now reaches at a shorter distance
+void DistanceOracle::resumeSearch(vector<vector<LabelEntry>> &labels, uint32_t rank, uint32_t start,
+                                  uint32_t start_distance, vector<uint32_t> &root_distance, vector<bool> &queued) const
+{
+    uint32_t root = vertex_of_rank[rank];
+    for (const LabelEntry &entry : labels[root])
+    {
+        root_distance[entry.rank] = entry.distance;
+    }
+
+    vector<pair<uint32_t, uint32_t>> queue = {{start, start_distance}};
+    queued[start] = true;
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        uint32_t node = queue[head].first;
+        uint32_t node_distance = queue[head].second;
+
+        bool covered = false;
+        for (const LabelEntry &entry : labels[node])
+        {
+            if (root_distance[entry.rank] != Unreachable &&
+                root_distance[entry.rank] + entry.distance <= node_distance)
+            {
+                covered = true;
+                break;
+            }
+        }
+        if (covered)
+        {
+            continue;
+        }
+
+        vector<LabelEntry> &label = labels[node];
+        auto it = lower_bound(label.begin(), label.end(), rank,
+                              [](const LabelEntry &entry, uint32_t value) { return entry.rank < value; });
+        if (it != label.end() && it->rank == rank)
+        {
+            it->distance = node_distance;
+        }
+        else
+        {
+            label.insert(it, {rank, node_distance});
+        }
+
+        for (const uint32_t *neighbor = graph->neighborsBegin(node); neighbor != graph->neighborsEnd(node); ++neighbor)
+        {
+            if (!queued[*neighbor])
+            {
+                queued[*neighbor] = true;
+                queue.emplace_back(*neighbor, node_distance + 1);
+            }
+        }
+    }
+
+    for (const auto &entry : queue)
+    {
+        queued[entry.first] = false;
+    }
+    for (const LabelEntry &entry : labels[root])
+    {
+        root_distance[entry.rank] = Unreachable;
+    }
+}
+
+vector<vector<DistanceOracle::LabelEntry>> DistanceOracle::getLabels() const
+{
+    vector<vector<LabelEntry>> labels(graph->size());
+    for (uint32_t node = 0; node + 1 < label_offsets.size(); node++)
+    {
+        for (uint32_t i = label_offsets[node]; i + 1 < label_offsets[node + 1]; i++)
+        {
+            labels[node].push_back({label_ranks[i], label_distances[i]});
+        }
+    }
+    return labels;
+}
+
+void DistanceOracle::setLabels(const vector<vector<LabelEntry>> &labels)
+{
+    size_t total = labels.size();
+    for (const auto &label : labels)
+    {
+        total += label.size();
+    }
+
+    label_offsets.assign(1, 0);
+    label_ranks.clear();
+    label_distances.clear();
+    label_offsets.reserve(labels.size() + 1);
+    label_ranks.reserve(total);
+    label_distances.reserve(total);
+    for (const auto &label : labels)
+    {
+        for (const LabelEntry &entry : label)
+        {
+            label_ranks.push_back(entry.rank);
+            label_distances.push_back(entry.distance);
+        }
+        label_ranks.push_back(Unreachable);
+        label_distances.push_back(0);
+        label_offsets.push_back(label_ranks.size());
+    }
+}
+
+uint32_t DistanceOracle::distance(uint32_t a, uint32_t b) const
+{
+    if (a == b)
+    {
+        return 0;
+    }
+
+    // Merge the two rank-sorted labels, a common landmark gives a path through it
+    const uint32_t *first_ranks = label_ranks.data() + label_offsets[a];
+    const uint32_t *second_ranks = label_ranks.data() + label_offsets[b];
+    const uint32_t *first_distances = label_distances.data() + label_offsets[a];
+    const uint32_t *second_distances = label_distances.data() + label_offsets[b];
+    uint32_t best = Unreachable;
+    for (size_t i = 0, j = 0;;)
+    {
+        uint32_t first = first_ranks[i], second = second_ranks[j];
+        if (first == second)
+        {
+            if (first == Unreachable)
+            {
+                break; // Both sentinels
+            }
+            best = min(best, first_distances[i] + second_distances[j]);
+        }
+        i += first <= second;
+        j += second <= first;
+    }
+    return best;
+}
+
+size_t DistanceOracle::getLabelEntries() const
+{
+    return label_ranks.size() - graph->size(); // Without the sentinels
+}
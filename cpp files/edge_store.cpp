@@ -0,0 +1,180 @@
+#include "edge_store.h"
+#include "trace.h"
+#include "memory_accounting.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+static const char EdgeMagic[4] = {'E', 'D', 'G', 'E'};
+static const uint32_t EdgeFormatVersion = 1;
+
+// Static Helper Functions
+static void writeVarint(string &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static bool readVarint(const string &in, size_t &pos, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+        unsigned char byte = in[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+EdgeStore::EdgeStore(const string &edge_file) : edge_file_path(edge_file) {}
+
+bool EdgeStore::exists() const
+{
+    ifstream file(edge_file_path);
+    return file.good();
+}
+
+bool EdgeStore::save(const unordered_map<string, vector<string>> &connections) const
+{
+    Trace::Span span("edge store save", "io");
+    // Dense index for every ID that appears as a key or a neighbor
+    vector<string> ids;
+    unordered_map<string, uint32_t> index;
+    auto getIndex = [&](const string &id) -> uint32_t
+    {
+        auto it = index.find(id);
+        if (it != index.end())
+        {
+            return it->second;
+        }
+        index[id] = ids.size();
+        ids.push_back(id);
+        return ids.size() - 1;
+    };
+
+    vector<vector<uint32_t>> adjacency;
+    for (const auto &entry : connections)
+    {
+        uint32_t from = getIndex(entry.first);
+        if (adjacency.size() <= from)
+            adjacency.resize(from + 1);
+        for (const auto &neighbor_id : entry.second)
+        {
+            uint32_t to = getIndex(neighbor_id);
+            adjacency[from].push_back(to);
+        }
+    }
+    adjacency.resize(ids.size());
+
+    // Encode into one buffer, then write it out in a single call
+    string buffer(EdgeMagic, sizeof(EdgeMagic));
+    writeVarint(buffer, EdgeFormatVersion);
+    writeVarint(buffer, ids.size());
+    for (const auto &id : ids)
+    {
+        writeVarint(buffer, id.size());
+        buffer += id;
+    }
+
+    for (auto &neighbors : adjacency)
+    {
+        sort(neighbors.begin(), neighbors.end()); // Duplicates are kept (delta 0)
+        writeVarint(buffer, neighbors.size());
+        uint32_t previous = 0;
+        for (uint32_t neighbor : neighbors)
+        {
+            writeVarint(buffer, neighbor - previous);
+            previous = neighbor;
+        }
+    }
+
+    string temp_path = edge_file_path + ".tmp";
+    ofstream file(temp_path, ios::binary);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open edge file for writing." << endl;
+        return false;
+    }
+    file.write(buffer.data(), buffer.size());
+    file.close();
+    if (!file)
+    {
+        return false;
+    }
+    return rename(temp_path.c_str(), edge_file_path.c_str()) == 0;
+}
+
+bool EdgeStore::load(unordered_map<string, vector<string>> &connections) const
+{
+    Trace::Span span("edge store load", "io");
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Connections);
+    ifstream file(edge_file_path, ios::binary | ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // One sequential read of the whole file
+    string buffer(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if (!file.read(&buffer[0], buffer.size()) || buffer.compare(0, sizeof(EdgeMagic), EdgeMagic, sizeof(EdgeMagic)) != 0)
+    {
+        return false;
+    }
+
+    size_t pos = sizeof(EdgeMagic);
+    uint64_t format_version, num_ids;
+    if (!readVarint(buffer, pos, format_version) || format_version != EdgeFormatVersion ||
+        !readVarint(buffer, pos, num_ids) || num_ids > buffer.size())
+    {
+        return false;
+    }
+
+    vector<string> ids(num_ids);
+    for (auto &id : ids)
+    {
+        uint64_t length;
+        if (!readVarint(buffer, pos, length) || pos + length > buffer.size())
+        {
+            return false;
+        }
+        id.assign(buffer, pos, length);
+        pos += length;
+    }
+
+    unordered_map<string, vector<string>> loaded;
+    loaded.reserve(num_ids);
+    for (uint64_t i = 0; i < num_ids; i++)
+    {
+        uint64_t degree;
+        if (!readVarint(buffer, pos, degree) || degree > buffer.size())
+        {
+            return false;
+        }
+
+        vector<string> &neighbors = loaded[ids[i]];
+        neighbors.reserve(degree);
+        uint64_t current = 0;
+        for (uint64_t j = 0; j < degree; j++)
+        {
+            uint64_t delta;
+            if (!readVarint(buffer, pos, delta) || current + delta >= num_ids)
+            {
+                return false;
+            }
+            current += delta;
+            neighbors.push_back(ids[current]);
+        }
+    }
+
+    connections = move(loaded);
+    return true;
+}
@@ -0,0 +1,296 @@
+#include "force_layout.h"
+#include "trace.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+ForceLayout::ForceLayout(size_t num_nodes, vector<Edge> edges, const vector<int> &community, Settings settings)
+    : num_nodes(num_nodes), edges(move(edges)), settings(settings),
+      positions(num_nodes), mass(num_nodes, 1.0), forces(num_nodes), previous_forces(num_nodes)
+{
+    // Normalize weights to (0, 1] and derive masses from degrees
+    double max_weight = 0.0;
+    for (const auto &edge : this->edges)
+    {
+        max_weight = max(max_weight, edge.weight);
+        mass[edge.from] += 1.0;
+        mass[edge.to] += 1.0;
+    }
+    for (auto &edge : this->edges)
+    {
+        edge.weight = max_weight > 0 ? edge.weight / max_weight : 1.0;
+    }
+
+    placeByCommunity(community);
+}
+
+void ForceLayout::placeByCommunity(const vector<int> &community)
+{
+    mt19937 rng(settings.seed);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Community sizes decide how much room each cluster gets
+    int num_communities = 0;
+    for (int c : community)
+    {
+        num_communities = max(num_communities, c + 1);
+    }
+    vector<size_t> sizes(num_communities, 0);
+    for (int c : community)
+    {
+        if (c >= 0)
+            sizes[c]++;
+    }
+
+    // Clusters start on a ring, so the layout only has to refine them
+    double ring_radius = 10.0 * sqrt(static_cast<double>(num_nodes));
+    vector<pair<double, double>> centers(num_communities);
+    for (int c = 0; c < num_communities; c++)
+    {
+        double angle = 2.0 * M_PI * c / max(1, num_communities);
+        centers[c] = {ring_radius * cos(angle), ring_radius * sin(angle)};
+    }
+
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        int c = i < community.size() ? community[i] : -1;
+        double center_x = c >= 0 ? centers[c].first : 0.0;
+        double center_y = c >= 0 ? centers[c].second : 0.0;
+        double radius = c >= 0 ? 5.0 * sqrt(static_cast<double>(sizes[c])) : ring_radius;
+
+        // Uniform point in a disc
+        double r = radius * sqrt(unit(rng));
+        double angle = 2.0 * M_PI * unit(rng);
+        positions[i] = {center_x + r * cos(angle), center_y + r * sin(angle)};
+    }
+}
+
+void ForceLayout::buildQuadTree()
+{
+    cells.clear();
+    if (num_nodes == 0)
+    {
+        return;
+    }
+
+    double min_x = numeric_limits<double>::max(), max_x = numeric_limits<double>::lowest();
+    double min_y = numeric_limits<double>::max(), max_y = numeric_limits<double>::lowest();
+    for (const auto &p : positions)
+    {
+        min_x = min(min_x, p.first);
+        max_x = max(max_x, p.first);
+        min_y = min(min_y, p.second);
+        max_y = max(max_y, p.second);
+    }
+
+    Cell root;
+    root.center_x = (min_x + max_x) / 2;
+    root.center_y = (min_y + max_y) / 2;
+    root.half_size = max(max_x - min_x, max_y - min_y) / 2 + 1e-6;
+    cells.reserve(4 * num_nodes);
+    cells.push_back(root);
+
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        insertBody(i);
+    }
+}
+
+void ForceLayout::insertBody(int body)
+{
+    const double x = positions[body].first, y = positions[body].second, m = mass[body];
+    auto childFor = [](const Cell &cell, double px, double py)
+    {
+        return (px >= cell.center_x ? 1 : 0) + (py >= cell.center_y ? 2 : 0);
+    };
+
+    int current = 0;
+    while (true)
+    {
+        // Empty leaf: store the body here
+        if (cells[current].children < 0 && cells[current].body < 0 && cells[current].mass == 0)
+        {
+            cells[current].body = body;
+            cells[current].mass = m;
+            cells[current].mass_x = m * x;
+            cells[current].mass_y = m * y;
+            return;
+        }
+
+        // Occupied leaf: split it, unless the bodies practically coincide
+        if (cells[current].children < 0)
+        {
+            if (cells[current].half_size < 1e-9)
+            {
+                cells[current].mass += m;
+                cells[current].mass_x += m * x;
+                cells[current].mass_y += m * y;
+                return;
+            }
+
+            int first_child = cells.size();
+            double quarter = cells[current].half_size / 2;
+            for (int k = 0; k < 4; k++)
+            {
+                Cell child;
+                child.center_x = cells[current].center_x + (k & 1 ? quarter : -quarter);
+                child.center_y = cells[current].center_y + (k & 2 ? quarter : -quarter);
+                child.half_size = quarter;
+                cells.push_back(child);
+            }
+
+            // Push the resident body one level down
+            int resident = cells[current].body;
+            Cell &target = cells[first_child + childFor(cells[current], positions[resident].first, positions[resident].second)];
+            target.body = resident;
+            target.mass = cells[current].mass;
+            target.mass_x = cells[current].mass_x;
+            target.mass_y = cells[current].mass_y;
+
+            cells[current].body = -1;
+            cells[current].children = first_child;
+        }
+
+        cells[current].mass += m;
+        cells[current].mass_x += m * x;
+        cells[current].mass_y += m * y;
+        current = cells[current].children + childFor(cells[current], x, y);
+    }
+}
+
+void ForceLayout::addRepulsion(int node, double &force_x, double &force_y) const
+{
+    const double x = positions[node].first, y = positions[node].second;
+    const double k = settings.scaling * mass[node];
+
+    int stack[256];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Cell &cell = cells[stack[--top]];
+        if (cell.mass == 0 || cell.body == node)
+        {
+            continue;
+        }
+
+        double dx = x - cell.mass_x / cell.mass;
+        double dy = y - cell.mass_y / cell.mass;
+        double distance_sq = dx * dx + dy * dy;
+
+        // Far enough away (or a leaf): treat the whole cell as one body
+        if (cell.children < 0 || 4 * cell.half_size * cell.half_size < settings.theta * settings.theta * distance_sq)
+        {
+            if (distance_sq > 0)
+            {
+                double factor = k * cell.mass / distance_sq; // Magnitude k * m1 * m2 / d
+                force_x += dx * factor;
+                force_y += dy * factor;
+            }
+            continue;
+        }
+
+        for (int c = 0; c < 4 && top < 256; c++)
+        {
+            stack[top++] = cell.children + c;
+        }
+    }
+}
+
+void ForceLayout::step()
+{
+    swap(forces, previous_forces);
+    buildQuadTree();
+
+    // Repulsion and gravity, independent per node
+    #pragma omp parallel
+    {
+        Trace::Span worker_span("repulsion worker", "render");
+
+        #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < num_nodes; i++)
+        {
+            double force_x = 0, force_y = 0;
+            addRepulsion(i, force_x, force_y);
+
+            double distance = sqrt(positions[i].first * positions[i].first + positions[i].second * positions[i].second);
+            if (distance > 0)
+            {
+                double factor = settings.gravity * mass[i] / distance;
+                force_x -= positions[i].first * factor;
+                force_y -= positions[i].second * factor;
+            }
+            forces[i] = {force_x, force_y};
+        }
+    }
+
+    // Linear attraction along edges
+    for (const auto &edge : edges)
+    {
+        double dx = positions[edge.from].first - positions[edge.to].first;
+        double dy = positions[edge.from].second - positions[edge.to].second;
+        forces[edge.from].first -= dx * edge.weight;
+        forces[edge.from].second -= dy * edge.weight;
+        forces[edge.to].first += dx * edge.weight;
+        forces[edge.to].second += dy * edge.weight;
+    }
+
+    // Adaptive global speed: slow down when nodes oscillate, speed up when they move together
+    double total_swinging = 0, total_traction = 0;
+    #pragma omp parallel for reduction(+ : total_swinging, total_traction)
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        double swing_x = forces[i].first - previous_forces[i].first;
+        double swing_y = forces[i].second - previous_forces[i].second;
+        double traction_x = forces[i].first + previous_forces[i].first;
+        double traction_y = forces[i].second + previous_forces[i].second;
+        total_swinging += mass[i] * sqrt(swing_x * swing_x + swing_y * swing_y);
+        total_traction += mass[i] * 0.5 * sqrt(traction_x * traction_x + traction_y * traction_y);
+    }
+
+    double n = static_cast<double>(num_nodes);
+    double estimated_jitter = 0.05 * sqrt(n);
+    double jitter = settings.jitter_tolerance *
+                    max(sqrt(estimated_jitter), min(10.0, estimated_jitter * total_traction / (n * n)));
+    const double min_speed_efficiency = 0.05;
+
+    if (total_traction > 0 && total_swinging / total_traction > 2.0)
+    {
+        if (speed_efficiency > min_speed_efficiency)
+            speed_efficiency *= 0.5;
+        jitter = max(jitter, settings.jitter_tolerance);
+    }
+
+    double target_speed = total_swinging > 0 ? jitter * speed_efficiency * total_traction / total_swinging : speed;
+    if (total_swinging > jitter * total_traction)
+    {
+        if (speed_efficiency > min_speed_efficiency)
+            speed_efficiency *= 0.7;
+    }
+    else if (speed < 1000)
+    {
+        speed_efficiency *= 1.3;
+    }
+    speed += min(target_speed - speed, 0.5 * speed); // Rise at most 50% per step
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        double swing_x = forces[i].first - previous_forces[i].first;
+        double swing_y = forces[i].second - previous_forces[i].second;
+        double swinging = mass[i] * sqrt(swing_x * swing_x + swing_y * swing_y);
+        double factor = speed / (1.0 + sqrt(speed * swinging));
+        positions[i].first += forces[i].first * factor;
+        positions[i].second += forces[i].second * factor;
+    }
+}
+
+const vector<pair<double, double>> &ForceLayout::run()
+{
+    Trace::Span span("force layout", "render");
+    for (int i = 0; i < settings.iterations && num_nodes > 1; i++)
+    {
+        step();
+    }
+    return positions;
+}
@@ -1,22 +1,85 @@
 #include "graph_visualizer.h"
+#include "force_layout.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_accounting.h"
 #include <bits/stdc++.h>
 // #include <filesystem>
 
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
 using namespace std;
 
+// Metrics
+static const Metrics::Counter bytes_written = Metrics::counter("visualizer_bytes_written_total", "DOT bytes piped to the renderer and SVG bytes written");
+static const Metrics::Counter edges_drawn = Metrics::counter("visualizer_edges_drawn_total", "Edges drawn in native SVG renderings");
+static const Metrics::Histogram dot_render_seconds = Metrics::histogram("visualizer_dot_render_seconds", "Graphviz renderings, DOT generation included");
+static const Metrics::Histogram layout_seconds = Metrics::histogram("visualizer_layout_seconds", "Force-directed layout runs");
+static const Metrics::Histogram svg_render_seconds = Metrics::histogram("visualizer_svg_render_seconds", "Native SVG renderings, layout included");
+
+// Static Helper Functions
+// Escapes text for SVG content and attribute values
+static string escapeXml(const string& text) {
+    string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&': escaped += "&amp;"; break;
+        case '<': escaped += "&lt;"; break;
+        case '>': escaped += "&gt;"; break;
+        case '"': escaped += "&quot;"; break;
+        case '\'': escaped += "&apos;"; break;
+        default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// Escapes text for a double-quoted DOT ID or label
+static string escapeDot(const string& text) {
+    string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Quotes a path for the shell popen runs, so spaces and metacharacters stay literal
+static string quoteShellArgument(const string& argument) {
+#ifdef _WIN32
+    return "\"" + argument + "\"";  // cmd.exe; Windows paths cannot contain quotes
+#else
+    string quoted = "'";
+    for (char c : argument) {
+        if (c == '\'') {
+            quoted += "'\\''";  // Close, escaped quote, reopen
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+#endif
+}
+
 GraphVisualizer::GraphVisualizer(double threshold) : weight_threshold(threshold) {}
 
-// Function to read the adjacency matrix from a CSV file and populate user IDs
-vector<vector<double>> GraphVisualizer::readAdjacencyMatrix(
-    const string& matrix_file, vector<string>& user_ids) {
+// Function to read the adjacency matrix from a CSV file into user IDs and an edge list
+bool GraphVisualizer::readAdjacencyMatrix(
+    const string& matrix_file, vector<string>& user_ids, vector<Edge>& edges) {
     
     ifstream file(matrix_file);
     if (!file.is_open()) {
         cerr << "Could not open matrix file: " << matrix_file << endl;
-        return vector<vector<double>>();
+        return false;
     }
 
-    vector<vector<double>> matrix;
     string line;
 
     // Read header to get user IDs
@@ -32,51 +95,120 @@ vector<vector<double>> GraphVisualizer::readAdjacencyMatrix(
         }
     }
 
-    // Read matrix data
+    // Read matrix data, keeping each nonzero pair once (the matrix is symmetric)
+    size_t row_index = 0;
     while (getline(file, line)) {
-        vector<double> row;
         stringstream ss(line);
         string cell;
+        size_t column = 0;
 
         getline(ss, cell, ',');  // Skip row header
 
         while (getline(ss, cell, ',')) {
-            if (!cell.empty()) {
-                try {
-                    row.push_back(stod(cell));
-                } catch (const exception& e) {
-                    cerr << "Error converting value: " << cell << endl;
-                    row.push_back(0.0);
-                }
+            if (cell.empty()) {
+                continue;
             }
+            double weight = 0.0;
+            try {
+                weight = stod(cell);
+            } catch (const exception& e) {
+                cerr << "Error converting value: " << cell << endl;
+            }
+            if (column > row_index && column < user_ids.size() && weight != 0.0) {
+                edges.push_back({row_index, column, weight});
+            }
+            column++;
         }
 
-        if (!row.empty()) {
-            matrix.push_back(row);
+        if (column > 0) {
+            row_index++;
         }
     }
 
     file.close();
-    return matrix;
+    return row_index > 0;
 }
 
-// Function to create a graph from the adjacency matrix and communities
+// Function to create a graph from the adjacency matrix file and communities
 void GraphVisualizer::createGraph(const string& matrix_file,
                                    const vector<vector<User*>>& communities,
                                    const string& output_file) {
-    
-    vector<string> user_ids;
-    vector<vector<double>> matrix = readAdjacencyMatrix(matrix_file, user_ids);
 
-    if (matrix.empty()) {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Rendering);
+
+    vector<string> user_ids;
+    vector<Edge> edges;
+    if (!readAdjacencyMatrix(matrix_file, user_ids, edges)) {
         cerr << "Failed to read adjacency matrix" << endl;
         return;
     }
 
-    string dot_file = "temp_graph.dot";
-    ofstream dot_out(dot_file);
-    dot_out << generateDotFormat(matrix, user_ids, communities);
-    dot_out.close();
+    renderDot(user_ids, edges, communities, output_file);
+}
+
+// Function to create a graph straight from an edge list already held in memory
+void GraphVisualizer::createGraph(const vector<string>& user_ids,
+                                   const vector<Edge>& edges,
+                                   const vector<vector<User*>>& communities,
+                                   const string& output_file) {
+
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Rendering);
+
+    if (user_ids.empty()) {
+        cerr << "Graph has no users" << endl;
+        return;
+    }
+
+    renderDot(user_ids, edges, communities, output_file);
+}
+
+// Minimal stream buffer over a C stdio handle, so DOT text goes straight into the pipe
+namespace {
+class StdioStreamBuffer : public streambuf {
+public:
+    explicit StdioStreamBuffer(FILE* file) : file(file) {
+        setp(buffer, buffer + sizeof(buffer));
+    }
+    ~StdioStreamBuffer() override { sync(); }
+
+    size_t written = 0;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (sync() != 0) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        size_t pending = pptr() - pbase();
+        if (pending > 0 && fwrite(pbase(), 1, pending, file) != pending) {
+            return -1;
+        }
+        written += pending;
+        setp(buffer, buffer + sizeof(buffer));
+        return 0;
+    }
+
+private:
+    FILE* file;
+    char buffer[1 << 16];
+};
+}
+
+// Function to pipe the DOT document into the renderer without a temporary file
+bool GraphVisualizer::renderDot(const vector<string>& user_ids,
+                                const vector<Edge>& edges,
+                                const vector<vector<User*>>& communities,
+                                const string& output_file) {
+
+    Metrics::ScopedTimer timer(dot_render_seconds);
+    Trace::Span span("render dot", "render");
 
     // Construct the output path by combining png_graphs directory with output filename
     string output_path = "png_graphs/" + output_file;
@@ -91,25 +223,38 @@ void GraphVisualizer::createGraph(const string& matrix_file,
                      " -Gstart=random"
                      " -Gepsilon=0.0001"
                      " -Gmaxiter=1000"
-                     " " + dot_file + " -o " + output_path;
+                     " -o " + quoteShellArgument(output_path);  // DOT text arrives on stdin
 
-    int result = system(command.c_str());
+    FILE* pipe = popen(command.c_str(), "w");
+    if (!pipe) {
+        cerr << "Failed to start the graph renderer" << endl;
+        return false;
+    }
+
+    {
+        StdioStreamBuffer buffer(pipe);
+        ostream dot(&buffer);
+        writeDotFormat(dot, user_ids, edges, communities);
+        dot.flush();
+        bytes_written.add(buffer.written);
+    }
+    int result = pclose(pipe);
 
     if (result == 0) {
         cout << "Graph visualization created successfully: " << output_path << endl;
-        remove(dot_file.c_str());
-    } else {
-        cerr << "Failed to create graph visualization" << endl;
+        return true;
     }
+    cerr << "Failed to create graph visualization" << endl;
+    return false;
 }
 
-// Function to generate the DOT format string for graph visualization
-string GraphVisualizer::generateDotFormat(
-    const vector<vector<double>>& matrix,
+// Function to stream the DOT document for graph visualization
+void GraphVisualizer::writeDotFormat(
+    ostream& dot,
     const vector<string>& user_ids,
+    const vector<Edge>& edges,
     const vector<vector<User*>>& communities) {
 
-    stringstream dot;
     dot << "graph Network {\n";
 
     // Graph attributes - Modified to constrain layout area
@@ -198,49 +343,229 @@ string GraphVisualizer::generateDotFormat(
     }
     dot << "    }\n\n";
 
-    // Create a map to store user_id to community index mapping
-    unordered_map<string, size_t> userCommunityMap;
-    for (size_t communityIdx = 0; communityIdx < communities.size(); communityIdx++) {
-        for (const User* user : communities[communityIdx]) {
-            userCommunityMap[user->getID()] = communityIdx;
-        }
-    }
-
     // Add graph nodes with community colors
     for (size_t i = 0; i < communities.size(); i++) {
         for (const User* user : communities[i]) {
-            dot << "    \"" << user->getID() << "\" ["
+            dot << "    \"" << escapeDot(user->getID()) << "\" ["
                 << "fillcolor=" << colors[i % colors.size()]
-                << ", label=\"" << user->getName() << "\"];\n";
+                << ", label=\"" << escapeDot(string(user->getName())) << "\"];\n";
         }
     }
     dot << "\n";
 
     // Add edges with constraints to keep within main graph area
     int edge_count = 0;
-    for (size_t i = 0; i < matrix.size(); i++) {
-        for (size_t j = i + 1; j < matrix[i].size(); j++) {
-            bool exceedsThreshold = (matrix[i][j] >= weight_threshold);
-
-            if (exceedsThreshold) {
-                double len = min(0.3, 19.0 / matrix[i][j]);
-                dot << "    \"" << user_ids[i] << "\" -- \"" << user_ids[j] 
-                    << "\" [len=" << len
-                    << ", penwidth=2.5];\n";
-                edge_count++;
-            }
+    for (const Edge& edge : edges) {
+        if (edge.weight >= weight_threshold) {
+            double len = min(0.3, 19.0 / edge.weight);
+            dot << "    \"" << escapeDot(user_ids[edge.from]) << "\" -- \"" << escapeDot(user_ids[edge.to])
+                << "\" [len=" << len
+                << ", penwidth=2.5];\n";
+            edge_count++;
         }
     }
 
     // Add constraint to keep nodes within main graph area
     dot << "    {rank=same; ";
     for (const auto& user_id : user_ids) {
-        dot << "\"" << user_id << "\"; ";
+        dot << "\"" << escapeDot(user_id) << "\"; ";
     }
     dot << "}\n";
     cout << "Number of edges: " << edge_count << endl <<endl;
 
 
     dot << "}\n";
-    return dot.str();
+}
+
+// Function to lay out the graph natively and write it as SVG
+void GraphVisualizer::createSvg(const vector<string>& user_ids,
+                                const vector<Edge>& edges,
+                                const vector<vector<User*>>& communities,
+                                const string& output_file) {
+
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Rendering);
+
+    // Dense node index: community members first (they carry names), then any other user
+    vector<SvgNode> nodes;
+    unordered_map<string, int> node_index;
+    for (size_t i = 0; i < communities.size(); i++) {
+        for (const User* user : communities[i]) {
+            if (node_index.emplace(user->getID(), nodes.size()).second) {
+                nodes.push_back({user->getID(), string(user->getName()), static_cast<int>(i), 5.0});
+            }
+        }
+    }
+    for (const auto& user_id : user_ids) {
+        if (node_index.emplace(user_id, nodes.size()).second) {
+            nodes.push_back({user_id, user_id, -1, 5.0});
+        }
+    }
+
+    // Same edge rule as the DOT output
+    vector<ForceLayout::Edge> layout_edges;
+    for (const Edge& edge : edges) {
+        if (edge.weight >= weight_threshold) {
+            layout_edges.push_back({node_index[user_ids[edge.from]], node_index[user_ids[edge.to]], edge.weight});
+        }
+    }
+
+    layoutAndWriteSvg(nodes, layout_edges, output_file);
+}
+
+// Function to draw communities as supernodes, with selected communities expanded to members
+void GraphVisualizer::createCommunityOverview(const vector<string>& user_ids,
+                                              const vector<Edge>& edges,
+                                              const vector<vector<User*>>& communities,
+                                              const unordered_set<int>& expanded_communities,
+                                              const string& output_file) {
+
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Rendering);
+
+    vector<SvgNode> nodes;
+    unordered_map<string, int> node_of_user; // User ID -> drawn node (supernode or member)
+    for (size_t i = 0; i < communities.size(); i++) {
+        if (expanded_communities.count(i)) {
+            for (const User* user : communities[i]) {
+                node_of_user[user->getID()] = nodes.size();
+                nodes.push_back({user->getID(), string(user->getName()), static_cast<int>(i), 5.0});
+            }
+        } else if (!communities[i].empty()) {
+            for (const User* user : communities[i]) {
+                node_of_user[user->getID()] = nodes.size();
+            }
+            size_t members = communities[i].size();
+            nodes.push_back({"community_" + to_string(i + 1),
+                             "Community " + to_string(i + 1) + ", " + to_string(members) + " members",
+                             static_cast<int>(i), 5.0 + 3.0 * sqrt(static_cast<double>(members))});
+        }
+    }
+
+    // Sum the above-threshold weights between drawn nodes, dropping edges inside a supernode
+    vector<int> drawn(user_ids.size(), -1);
+    for (size_t i = 0; i < user_ids.size(); i++) {
+        auto it = node_of_user.find(user_ids[i]);
+        if (it != node_of_user.end()) {
+            drawn[i] = it->second;
+        }
+    }
+
+    unordered_map<uint64_t, double> total_weight;
+    for (const Edge& edge : edges) {
+        int from = drawn[edge.from], to = drawn[edge.to];
+        if (from < 0 || to < 0 || from == to || edge.weight < weight_threshold) {
+            continue;
+        }
+        uint64_t a = min(from, to), b = max(from, to);
+        total_weight[a << 32 | b] += edge.weight;
+    }
+
+    vector<ForceLayout::Edge> layout_edges;
+    layout_edges.reserve(total_weight.size());
+    for (const auto& entry : total_weight) {
+        layout_edges.push_back({static_cast<int>(entry.first >> 32), static_cast<int>(entry.first & 0xffffffff), entry.second});
+    }
+    sort(layout_edges.begin(), layout_edges.end(), [](const auto& x, const auto& y) {
+        return make_pair(x.from, x.to) < make_pair(y.from, y.to); // Stable output across runs
+    });
+
+    layoutAndWriteSvg(nodes, layout_edges, output_file);
+}
+
+// Function to run the force-directed layout and stream the drawing to an SVG file
+void GraphVisualizer::layoutAndWriteSvg(const vector<SvgNode>& nodes,
+                                        const vector<ForceLayout::Edge>& edges,
+                                        const string& output_file) {
+
+    Metrics::ScopedTimer timer(svg_render_seconds);
+    Trace::Span span("render svg", "render");
+
+    vector<int> node_community;
+    for (const auto& node : nodes) {
+        node_community.push_back(node.community);
+    }
+
+    ForceLayout layout(nodes.size(), edges, node_community, ForceLayout::Settings());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].radius > 5.0) {
+            layout.setMass(i, nodes[i].radius * nodes[i].radius / 25.0); // Big supernodes need room
+        }
+    }
+    {
+        Metrics::ScopedTimer layout_timer(layout_seconds);
+        layout.run();
+    }
+    const vector<pair<double, double>>& positions = layout.getPositions();
+
+    // Fit the layout into a fixed canvas
+    const double canvas = 2000.0, margin = 60.0;
+    double min_x = numeric_limits<double>::max(), max_x = numeric_limits<double>::lowest();
+    double min_y = numeric_limits<double>::max(), max_y = numeric_limits<double>::lowest();
+    for (const auto& p : positions) {
+        min_x = min(min_x, p.first);
+        max_x = max(max_x, p.first);
+        min_y = min(min_y, p.second);
+        max_y = max(max_y, p.second);
+    }
+    double scale = (canvas - 2 * margin) / max({max_x - min_x, max_y - min_y, 1e-9});
+    auto screenX = [&](int node) { return margin + (positions[node].first - min_x) * scale; };
+    auto screenY = [&](int node) { return margin + (positions[node].second - min_y) * scale; };
+
+    double max_weight = 0.0;
+    for (const auto& edge : edges) {
+        max_weight = max(max_weight, edge.weight);
+    }
+
+    string output_path = "png_graphs/" + output_file;
+    ofstream svg(output_path);
+    if (!svg.is_open()) {
+        cerr << "Could not open SVG file for writing: " << output_path << endl;
+        return;
+    }
+
+    svg << fixed << setprecision(1);
+    svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << canvas << "\" height=\"" << canvas
+        << "\" viewBox=\"0 0 " << canvas << " " << canvas << "\">\n";
+    svg << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+
+    svg << "<g stroke=\"#333333\" stroke-opacity=\"0.35\">\n";
+    for (const auto& edge : edges) {
+        svg << "<line x1=\"" << screenX(edge.from) << "\" y1=\"" << screenY(edge.from)
+            << "\" x2=\"" << screenX(edge.to) << "\" y2=\"" << screenY(edge.to)
+            << "\" stroke-width=\"" << 0.5 + 3.0 * edge.weight / max_weight << "\"/>\n";
+    }
+    svg << "</g>\n";
+
+    // Nodes on top of edges, names as tooltips; supernodes also get a visible label
+    svg << "<g stroke=\"#222222\" stroke-width=\"0.8\" font-family=\"Arial\" font-size=\"12\" text-anchor=\"middle\">\n";
+    for (size_t i = 0; i < nodes.size(); i++) {
+        svg << "<circle cx=\"" << screenX(i) << "\" cy=\"" << screenY(i) << "\" r=\"" << nodes[i].radius << "\" fill=\""
+            << (nodes[i].community >= 0 ? getNodeColor(nodes[i].community) : "#cccccc") << "\"><title>"
+            << escapeXml(nodes[i].label) << " (" << escapeXml(nodes[i].id) << ")</title></circle>\n";
+        if (nodes[i].radius > 5.0) {
+            svg << "<text x=\"" << screenX(i) << "\" y=\"" << screenY(i) + 4 << "\" stroke=\"none\">"
+                << escapeXml(nodes[i].label.substr(0, nodes[i].label.find(','))) << "</text>\n";
+        }
+    }
+    svg << "</g>\n";
+    svg << "</svg>\n";
+
+    if (!svg) {
+        cerr << "Failed to write SVG graph" << endl;
+        return;
+    }
+    bytes_written.add(svg.tellp());
+    edges_drawn.add(edges.size());
+    cout << "Number of edges: " << edges.size() << endl;
+    cout << "Graph visualization created successfully: " << output_path << endl;
+}
+
+// Function to get the fill color of a community
+string GraphVisualizer::getNodeColor(int community_index) {
+    static const array<string, 20> colors = {{
+        "#ff7f7f", "#7fbfff", "#7fff7f", "#ff7fff", "#ffff7f",
+        "#7fffff", "#ff9966", "#cccc66", "#9966ff", "#ff9966",
+        "#ff6666", "#66ccff", "#ffcc66", "#66ffcc", "#cc66ff",
+        "#ff66cc", "#ffccff", "#66cc66", "#cccc66", "#ccff66"
+    }};
+    return colors[community_index % colors.size()];
 }
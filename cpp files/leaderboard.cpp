@@ -0,0 +1,129 @@
+#include "leaderboard.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+bool Leaderboard::better(uint32_t a, uint32_t b) const
+{
+    // Absent slots (NaN) lose against everything
+    if (isnan(scores[b]))
+        return !isnan(scores[a]);
+    if (isnan(scores[a]))
+        return false;
+    return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+}
+
+void Leaderboard::grow(size_t min_slots)
+{
+    size_t new_capacity = max<size_t>(capacity, 16);
+    while (new_capacity < min_slots)
+    {
+        new_capacity *= 2;
+    }
+    if (new_capacity == capacity)
+    {
+        return;
+    }
+
+    capacity = new_capacity;
+    scores.resize(capacity, numeric_limits<double>::quiet_NaN());
+    winners.assign(2 * capacity, 0);
+
+    // Rebuild bottom-up in O(capacity)
+    for (size_t slot = 0; slot < capacity; slot++)
+    {
+        winners[capacity + slot] = slot;
+    }
+    for (size_t node = capacity - 1; node >= 1; node--)
+    {
+        uint32_t left = winners[2 * node], right = winners[2 * node + 1];
+        winners[node] = better(right, left) ? right : left;
+    }
+}
+
+void Leaderboard::replay(size_t leaf)
+{
+    for (size_t node = (capacity + leaf) / 2; node >= 1; node /= 2)
+    {
+        uint32_t left = winners[2 * node], right = winners[2 * node + 1];
+        uint32_t winner = better(right, left) ? right : left;
+        if (winners[node] == winner && winner != leaf)
+        {
+            break; // Nothing above can change either
+        }
+        winners[node] = winner;
+    }
+}
+
+void Leaderboard::update(uint32_t slot, double score)
+{
+    if (slot >= capacity)
+    {
+        grow(slot + 1);
+    }
+    if (scores[slot] == score)
+    {
+        return;
+    }
+
+    if (isnan(scores[slot]))
+    {
+        count++;
+    }
+    scores[slot] = score;
+    replay(slot);
+}
+
+void Leaderboard::remove(uint32_t slot)
+{
+    if (slot >= capacity || isnan(scores[slot]))
+    {
+        return;
+    }
+
+    scores[slot] = numeric_limits<double>::quiet_NaN();
+    count--;
+    replay(slot);
+}
+
+void Leaderboard::clear()
+{
+    capacity = 0;
+    count = 0;
+    scores.clear();
+    winners.clear();
+}
+
+vector<pair<uint32_t, double>> Leaderboard::top(size_t k) const
+{
+    vector<pair<uint32_t, double>> result;
+    if (capacity == 0)
+    {
+        return result;
+    }
+
+    // Best-first walk: a node's winner is the best entry in its subtree
+    auto worse = [this](size_t a, size_t b) { return better(winners[b], winners[a]); };
+    priority_queue<size_t, vector<size_t>, decltype(worse)> frontier(worse);
+    frontier.push(1);
+
+    while (!frontier.empty() && result.size() < k)
+    {
+        size_t node = frontier.top();
+        frontier.pop();
+
+        uint32_t winner = winners[node];
+        if (isnan(scores[winner]))
+        {
+            break; // Only absent slots remain
+        }
+        if (node >= capacity)
+        {
+            result.emplace_back(winner, scores[winner]);
+            continue;
+        }
+        frontier.push(2 * node);
+        frontier.push(2 * node + 1);
+    }
+    return result;
+}
@@ -0,0 +1,166 @@
+#include "link_predictor.h"
+#include <bits/stdc++.h>
+#include <omp.h>
+
+using namespace std;
+
+LinkPredictor::LinkPredictor(const unordered_map<string, vector<string>> &connections)
+{
+    // Assign a dense index to every user that appears in the connection map
+    auto getIndex = [&](const string &id) -> int
+    {
+        auto it = index.find(id);
+        if (it != index.end())
+        {
+            return it->second;
+        }
+        int new_index = ids.size();
+        index[id] = new_index;
+        ids.push_back(id);
+        adjacency.emplace_back();
+        return new_index;
+    };
+
+    for (const auto &entry : connections)
+    {
+        int from = getIndex(entry.first);
+        for (const auto &neighbor_id : entry.second)
+        {
+            int to = getIndex(neighbor_id);
+            if (to != from)
+            {
+                adjacency[from].push_back(to);
+            }
+        }
+    }
+
+    // Sort and remove duplicate edges so intersections can be done with a merge
+    inverse_log_degree.assign(ids.size(), 0.0);
+    for (size_t i = 0; i < adjacency.size(); ++i)
+    {
+        auto &neighbors = adjacency[i];
+        sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+        if (neighbors.size() > 1)
+        {
+            inverse_log_degree[i] = 1.0 / log(static_cast<double>(neighbors.size()));
+        }
+    }
+}
+
+vector<LinkPredictor::LinkScore> LinkPredictor::predictIndex(int user, size_t top_k, Scratch &scratch) const
+{
+    auto &common = scratch.common;
+    auto &adamic_adar = scratch.adamic_adar;
+    auto &touched = scratch.touched;
+    if (common.size() != ids.size())
+    {
+        common.assign(ids.size(), 0);
+        adamic_adar.assign(ids.size(), 0.0);
+    }
+
+    const auto &user_neighbors = adjacency[user];
+    touched.clear();
+
+    // Sparse A*A restricted to the row of this user: walk every two-hop path
+    for (int middle : user_neighbors)
+    {
+        for (int candidate : adjacency[middle])
+        {
+            if (candidate == user)
+            {
+                continue;
+            }
+            if (common[candidate] == 0)
+            {
+                touched.push_back(candidate);
+            }
+            common[candidate]++;
+            adamic_adar[candidate] += inverse_log_degree[middle];
+        }
+    }
+
+    vector<LinkScore> scores;
+    scores.reserve(touched.size());
+    for (int candidate : touched)
+    {
+        // Skip users that are already direct neighbors
+        if (!binary_search(user_neighbors.begin(), user_neighbors.end(), candidate))
+        {
+            int cn = common[candidate];
+            size_t union_size = user_neighbors.size() + adjacency[candidate].size() - cn;
+            scores.push_back({ids[candidate], cn,
+                              union_size > 0 ? static_cast<double>(cn) / union_size : 0.0,
+                              adamic_adar[candidate]});
+        }
+
+        // Reset scratch buffers for the next user
+        common[candidate] = 0;
+        adamic_adar[candidate] = 0.0;
+    }
+
+    auto byScore = [](const LinkScore &a, const LinkScore &b)
+    {
+        if (a.adamic_adar != b.adamic_adar)
+            return a.adamic_adar > b.adamic_adar;
+        return a.common_neighbors > b.common_neighbors;
+    };
+
+    if (top_k > 0 && scores.size() > top_k)
+    {
+        partial_sort(scores.begin(), scores.begin() + top_k, scores.end(), byScore);
+        scores.resize(top_k);
+    }
+    else
+    {
+        sort(scores.begin(), scores.end(), byScore);
+    }
+
+    return scores;
+}
+
+vector<LinkPredictor::LinkScore> LinkPredictor::predict(const string &user_id, size_t top_k) const
+{
+    Scratch scratch;
+    return predict(user_id, top_k, scratch);
+}
+
+vector<LinkPredictor::LinkScore> LinkPredictor::predict(const string &user_id, size_t top_k, Scratch &scratch) const
+{
+    auto it = index.find(user_id);
+    if (it == index.end())
+    {
+        return vector<LinkScore>();
+    }
+    return predictIndex(it->second, top_k, scratch);
+}
+
+unordered_map<string, vector<LinkPredictor::LinkScore>> LinkPredictor::predictAll(const vector<string> &user_ids,
+                                                                                   size_t top_k) const
+{
+    vector<vector<LinkScore>> results(user_ids.size());
+
+#pragma omp parallel
+    {
+        // Scratch buffers are per thread and reset after each user
+        Scratch scratch;
+
+#pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < user_ids.size(); i++)
+        {
+            auto it = index.find(user_ids[i]);
+            if (it != index.end())
+            {
+                results[i] = predictIndex(it->second, top_k, scratch);
+            }
+        }
+    }
+
+    unordered_map<string, vector<LinkScore>> predictions;
+    for (size_t i = 0; i < user_ids.size(); i++)
+    {
+        predictions[user_ids[i]] = move(results[i]);
+    }
+    return predictions;
+}
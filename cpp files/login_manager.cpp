@@ -1,8 +1,16 @@
 #include "login_manager.h"
+#include "metrics.h"
+#include "memory_accounting.h"
 #include <bits/stdc++.h>
 
 using namespace std;
 
+// Metrics
+static const Metrics::Counter login_failures = Metrics::counter("login_failures_total", "Logins rejected for an unknown ID or a wrong password");
+static const Metrics::Counter registrations = Metrics::counter("login_registrations_total", "Users registered, one by one or in bulk");
+static const Metrics::Histogram login_seconds = Metrics::histogram("login_seconds", "Login attempts");
+static const Metrics::Histogram register_seconds = Metrics::histogram("login_register_seconds", "Single-user registrations, including connection setup");
+
 LoginManager::LoginManager(ConnectionManager &cm) : cm(cm)
 {
     loadUsers();
@@ -10,6 +18,7 @@ LoginManager::LoginManager(ConnectionManager &cm) : cm(cm)
 
 void LoginManager::loadUsers()
 {
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::LoginManager);
     vector<User *> all_users = cm.getAllUsers();
     for (auto user : all_users)
     {
@@ -48,9 +57,11 @@ void LoginManager::saveUsers()
 
 User *LoginManager::login(const string &id, const string &password)
 {
-    if (users.find(id) != users.end())
+    Metrics::ScopedTimer timer(login_seconds);
+    auto it = users.find(id); // find() keeps concurrent logins read-only
+    if (it != users.end())
     {
-        User *user = users[id];
+        User *user = it->second;
         if (user->getPassword() == password)
         {
             cout << "Login successful!" << endl;
@@ -65,11 +76,14 @@ User *LoginManager::login(const string &id, const string &password)
     {
         cout << "No user found with that ID!" << endl;
     }
+    login_failures.add();
     return nullptr;
 }
 
 bool LoginManager::registerUser(const string &name, const string &id, const string &password, const string &category, double influence, const string &branch)
 {
+    Metrics::ScopedTimer timer(register_seconds);
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::LoginManager);
     if (users.find(id) != users.end())
     {
         cout << "User ID already exists!" << endl;
@@ -77,23 +91,16 @@ bool LoginManager::registerUser(const string &name, const string &id, const stri
     }
 
     // Create the new user
-    User *new_user = new User(name, id, password, category, influence, branch);
+    User *new_user = cm.createUser(name, id, password, category, influence, branch);
 
     // Add the user to the system
     cm.addUser(new_user);
     users[id] = new_user;
+    registrations.add();
 
-    // Append only the new user data to the file
-    ofstream file("user_data.csv", ios::app);
-    if (file.is_open())
+    // Append only the new user data to the file (queued when the manager writes in the background)
+    if (cm.persistNewUsers({new_user}))
     {
-        file << new_user->getName() << ","
-             << new_user->getID() << ","
-             << new_user->getPassword() << ","
-             << new_user->getCategory() << ","
-             << new_user->getInfluence() << ","
-             << new_user->getBranch() << "\n";
-        file.close();
         cout << "User registered successfully and saved to file!" << endl;
     }
     else
@@ -104,6 +111,91 @@ bool LoginManager::registerUser(const string &name, const string &id, const stri
     return true;
 }
 
+int LoginManager::registerUsers(const vector<UserRecord> &records)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::LoginManager);
+    vector<User *> new_users;
+    for (const auto &record : records)
+    {
+        if (users.find(record.id) != users.end())
+        {
+            cout << "Skipping existing user ID: " << record.id << endl;
+            continue;
+        }
+
+        User *new_user = cm.createUser(record.name, record.id, record.password,
+                                       record.category, record.influence, record.branch);
+        users[record.id] = new_user;
+        new_users.push_back(new_user);
+    }
+
+    // Connections, communities and the matrix are handled in a single pass
+    cm.addUsers(new_users);
+    registrations.add(new_users.size());
+
+    // Append the whole batch in one write
+    if (!cm.persistNewUsers(new_users))
+    {
+        cout << "Error opening file to save the new user data!" << endl;
+    }
+
+    return new_users.size();
+}
+
+int LoginManager::registerUsersFromFile(const string &file_path)
+{
+    ifstream file(file_path);
+    if (!file.is_open())
+    {
+        cout << "Error opening user import file: " << file_path << endl;
+        return 0;
+    }
+
+    vector<UserRecord> records;
+    string line;
+    size_t line_number = 1;
+    getline(file, line); // Skip header row
+
+    while (getline(file, line))
+    {
+        line_number++;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+
+        stringstream ss(line);
+        UserRecord record;
+        string influence;
+        getline(ss, record.name, ',');
+        getline(ss, record.id, ',');
+        getline(ss, record.password, ',');
+        getline(ss, record.category, ',');
+        getline(ss, influence, ',');
+        getline(ss, record.branch, ',');
+
+        // Reject the line rather than persisting a half-parsed user
+        size_t parsed = 0;
+        try
+        {
+            record.influence = stod(influence, &parsed);
+        }
+        catch (const exception &e)
+        {
+            parsed = 0;
+        }
+        if (record.id.empty() || parsed == 0 || parsed != influence.size())
+        {
+            cout << "Skipping invalid user on line " << line_number << ": " << line << endl;
+            continue;
+        }
+        records.push_back(record);
+    }
+    file.close();
+
+    return registerUsers(records);
+}
+
 bool LoginManager::isUserExist(const string &id)
 {
     return users.find(id) != users.end();
@@ -4,16 +4,119 @@
 #include "graph_visualizer.h"
 #include "connection_handler.h"
 #include "print_utilities.h"
+#include "socket_server.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_accounting.h"
+#include "parse_utilities.h"
 #include <bits/stdc++.h>
 
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
+    // Diagnostics: "--metrics <file>", "--trace <file>" and "--memory-report <file>" may precede any mode,
+    // all of them are written on exit
+    static string metrics_file, memory_report_file;
+    while (argc >= 3 && (string(argv[1]) == "--metrics" || string(argv[1]) == "--trace" ||
+                         string(argv[1]) == "--memory-report"))
+    {
+        if (string(argv[1]) == "--metrics")
+        {
+            metrics_file = argv[2];
+            atexit([]()
+                   { Metrics::writeToFile(metrics_file); });
+        }
+        else if (string(argv[1]) == "--memory-report")
+        {
+            memory_report_file = argv[2];
+            if (!MemoryAccounting::isEnabled())
+            {
+                cerr << "Warning: memory tracking is disabled in this build, the report will be empty" << endl;
+            }
+            atexit([]()
+                   { MemoryAccounting::writeReport(memory_report_file); });
+        }
+        else
+        {
+            Trace::start(argv[2]);
+            atexit([]()
+                   { Trace::stop(); });
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    // Mode arguments are checked before the network is loaded
+    size_t top_k = 10;
+    if (argc >= 4 && string(argv[1]) == "--batch-recommendations" && !ParseUtilities::parseCount(argv[3], top_k))
+    {
+        cerr << "Invalid k: " << argv[3] << endl;
+        cerr << "Usage: program --batch-recommendations <output file> [k, a positive count]" << endl;
+        return 1;
+    }
+    unordered_set<int> expanded;
+    if (argc >= 3 && string(argv[1]) == "--overview")
+    {
+        for (int i = 3; i < argc; i++)
+        {
+            size_t number = 0;
+            if (!ParseUtilities::parseCount(argv[i], number) || number > INT_MAX)
+            {
+                cerr << "Invalid community number: " << argv[i] << endl;
+                cerr << "Usage: program --overview <output file> [community numbers from the legend, starting at 1]" << endl;
+                return 1;
+            }
+            expanded.insert(static_cast<int>(number) - 1);
+        }
+    }
+
      string user_data_file = "user_data.csv";
     ConnectionManager cm(user_data_file);
+
+    // Batch mode: precompute top-k recommendations for every user and exit
+    if (argc >= 3 && string(argv[1]) == "--batch-recommendations")
+    {
+        size_t written = cm.writeRecommendationsForAllUsers(argv[2], top_k);
+         cout << "Wrote recommendations for " << written << " users to " << argv[2] <<  endl;
+        return 0;
+    }
+
+    // Overview mode: communities as supernodes, the listed ones (numbered as in the legend) expanded
+    if (argc >= 3 && string(argv[1]) == "--overview")
+    {
+        size_t community_count = cm.getCommunities().size();
+        for (int index : expanded)
+        {
+            if (static_cast<size_t>(index) >= community_count)
+            {
+                cerr << "No community " << index + 1 << "; the network has " << community_count << endl;
+                return 1;
+            }
+        }
+        cm.visualizeCommunities(argv[2], expanded);
+        return 0;
+    }
+
     LoginManager login_manager(cm);
 
+    // Service mode: load the network once and serve requests over a Unix socket
+    if (argc >= 3 && string(argv[1]) == "--serve")
+    {
+        SocketServer server(cm, login_manager, argv[2]);
+        bool served = server.run();
+        cm.saveAnalyticsSnapshot("analytics_snapshot.bin");
+        return served ? 0 : 1;
+    }
+
+    // Bulk import: onboard every user listed in a CSV file and exit
+    if (argc >= 3 && string(argv[1]) == "--import-users")
+    {
+        int imported = login_manager.registerUsersFromFile(argv[2]);
+         cout << "Imported " << imported << " users from " << argv[2] <<  endl;
+        return 0;
+    }
+
     // Choose between login or registration
      cout << "1. Login\n2. Register\nChoose an option: ";
     int choice;
@@ -81,22 +184,20 @@ int main()
         return 0;
     }
 
-    // Calculate centrality measures
-     unordered_map< string, double> betweenness = cm.calculateBetweennessCentrality();
-     unordered_map< string, double> closeness = cm.calculateClosenessCentrality();
-     unordered_map< string, double> pagerank = cm.calculatePageRank();
-
-    // Detect communities
-     vector< vector<User *>> communities = cm.detectCommunities();
+    // Only what is displayed is computed (PageRank and communities, both memoized)
+     vector< vector<User *>> communities = cm.getCommunities();
 
     // Print the results using PrintUtilities
-    PrintUtilities::printResults(cm, pagerank, communities);
+    PrintUtilities::printResults(cm, communities);
 
     // Handle connection management using ConnectionHandler
     ConnectionHandler::handleConnectionManagement(cm, user);
 
     // Visualize the updated graph
-    cm.visualizeGraph("updated_social_network_graph.png", betweenness, communities);
+    cm.visualizeGraph("updated_social_network_graph.svg", communities);
+
+    // Keep whatever analytics are current for the next start
+    cm.saveAnalyticsSnapshot("analytics_snapshot.bin");
 
     // GraphVisualizer visualizer(15.0);
     // visualizer.createGraph("adjacency_matrix.csv", communities, "social_network_graph.png");
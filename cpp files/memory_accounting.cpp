@@ -0,0 +1,243 @@
+#include "memory_accounting.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Nothing on the allocation path may allocate: the counters below are plain
+// atomics and trivially initialized thread locals.
+static constexpr size_t NumSubsystems = static_cast<size_t>(MemoryAccounting::Subsystem::Count);
+static constexpr size_t TotalSlot = NumSubsystems; // Sum over all subsystems
+
+static atomic<int64_t> live_bytes[NumSubsystems + 1];
+static atomic<int64_t> peak_bytes[NumSubsystems + 1];
+
+static thread_local uint8_t current_subsystem = 0;
+static thread_local int64_t pending_bytes[NumSubsystems + 1];
+static thread_local bool flusher_registered = false;
+
+// Static Helper Functions
+static void raisePeak(size_t slot, int64_t live)
+{
+    int64_t peak = peak_bytes[slot].load(memory_order_relaxed);
+    while (live > peak && !peak_bytes[slot].compare_exchange_weak(peak, live, memory_order_relaxed))
+    {
+    }
+}
+
+static void flushPending(size_t slot)
+{
+    int64_t delta = pending_bytes[slot];
+    if (delta == 0)
+    {
+        return;
+    }
+    pending_bytes[slot] = 0;
+    raisePeak(slot, live_bytes[slot].fetch_add(delta, memory_order_relaxed) + delta);
+}
+
+// Adds to a thread's pending bytes; the peak also sees bytes that are not flushed yet
+static void addPending(size_t slot, int64_t bytes)
+{
+    int64_t &pending = pending_bytes[slot];
+    pending += bytes;
+    if (pending > MemoryAccounting::PendingLimit || pending < -MemoryAccounting::PendingLimit)
+    {
+        flushPending(slot);
+    }
+    else if (bytes > 0)
+    {
+        int64_t live = live_bytes[slot].load(memory_order_relaxed) + pending;
+        if (live > peak_bytes[slot].load(memory_order_relaxed))
+        {
+            raisePeak(slot, live);
+        }
+    }
+}
+
+// Hands a thread's remaining pending bytes over when it exits
+struct PendingFlusher
+{
+    ~PendingFlusher()
+    {
+        for (size_t i = 0; i <= NumSubsystems; i++)
+        {
+            flushPending(i);
+        }
+    }
+};
+static thread_local PendingFlusher pending_flusher;
+
+static void recordBytes(uint8_t subsystem, int64_t bytes)
+{
+    if (!flusher_registered)
+    {
+        flusher_registered = true; // Set first: registering the flusher may allocate
+        static_cast<void>(&pending_flusher);
+    }
+
+    addPending(subsystem, bytes);
+    addPending(TotalSlot, bytes);
+}
+
+// Scopes
+MemoryAccounting::Scope::Scope(Subsystem subsystem) : previous(current_subsystem)
+{
+    current_subsystem = static_cast<uint8_t>(subsystem);
+}
+
+MemoryAccounting::Scope::~Scope()
+{
+    current_subsystem = previous;
+}
+
+// Reporting
+bool MemoryAccounting::isEnabled()
+{
+#ifdef SOCIAL_NETWORK_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *MemoryAccounting::getName(Subsystem subsystem)
+{
+    static const array<const char *, NumSubsystems> names = {{
+        "other", "users", "login_manager", "connections", "adjacency_matrix", "similarity_index", "snapshots",
+        "communities", "betweenness", "closeness", "pagerank", "distance_oracle", "analytics_cache", "recommendations", "rendering"
+    }};
+    return names[static_cast<size_t>(subsystem)];
+}
+
+vector<MemoryAccounting::Usage> MemoryAccounting::getUsage()
+{
+    // The calling thread's own pending bytes are made exact first
+    for (size_t i = 0; i <= NumSubsystems; i++)
+    {
+        flushPending(i);
+    }
+
+    vector<Usage> usage;
+    for (size_t i = 0; i <= NumSubsystems; i++)
+    {
+        usage.push_back({i == TotalSlot ? "total" : getName(static_cast<Subsystem>(i)),
+                         live_bytes[i].load(memory_order_relaxed), peak_bytes[i].load(memory_order_relaxed)});
+    }
+    return usage;
+}
+
+string MemoryAccounting::getReport()
+{
+    if (!isEnabled())
+    {
+        return "Memory tracking is disabled in this build (configure with -DSOCIAL_NETWORK_MEMORY_TRACKING=ON).\n";
+    }
+
+    ostringstream out;
+    out << left << setw(20) << "subsystem" << right << setw(14) << "live_kb" << setw(14) << "peak_kb" << "\n";
+    for (const Usage &entry : getUsage())
+    {
+        out << left << setw(20) << entry.name << right << setw(14) << entry.live_bytes / 1024
+            << setw(14) << entry.peak_bytes / 1024 << "\n";
+    }
+    return out.str();
+}
+
+bool MemoryAccounting::writeReport(const string &file_path)
+{
+    ofstream file(file_path);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open memory report " << file_path << " for writing." << endl;
+        return false;
+    }
+    file << getReport();
+    return true;
+}
+
+#ifdef SOCIAL_NETWORK_MEMORY_TRACKING
+
+// Tracking Allocator (replaces the global operator new/delete)
+namespace
+{
+struct alignas(max_align_t) BlockHeader
+{
+    size_t size;
+    uint8_t subsystem;
+};
+
+void *allocateTracked(size_t size)
+{
+    while (true)
+    {
+        void *block = malloc(sizeof(BlockHeader) + size);
+        if (block)
+        {
+            BlockHeader *header = static_cast<BlockHeader *>(block);
+            header->size = size;
+            header->subsystem = current_subsystem;
+            recordBytes(header->subsystem, static_cast<int64_t>(size));
+            return header + 1;
+        }
+
+        new_handler handler = get_new_handler();
+        if (!handler)
+        {
+            return nullptr;
+        }
+        handler();
+    }
+}
+
+void freeTracked(void *pointer)
+{
+    if (!pointer)
+    {
+        return;
+    }
+    BlockHeader *header = static_cast<BlockHeader *>(pointer) - 1;
+    recordBytes(header->subsystem, -static_cast<int64_t>(header->size));
+    free(header);
+}
+}
+
+void *operator new(size_t size)
+{
+    void *pointer = allocateTracked(size);
+    if (!pointer)
+    {
+        throw bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept
+{
+    try
+    {
+        return allocateTracked(size);
+    }
+    catch (...)
+    {
+        return nullptr; // A new_handler may throw
+    }
+}
+
+void *operator new[](size_t size, const nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept { freeTracked(pointer); }
+void operator delete[](void *pointer) noexcept { freeTracked(pointer); }
+void operator delete(void *pointer, size_t) noexcept { freeTracked(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { freeTracked(pointer); }
+void operator delete(void *pointer, const nothrow_t &) noexcept { freeTracked(pointer); }
+void operator delete[](void *pointer, const nothrow_t &) noexcept { freeTracked(pointer); }
+
+#endif
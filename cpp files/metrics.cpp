@@ -0,0 +1,290 @@
+#include "metrics.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Per-thread values. Only the owning thread writes (plain relaxed stores, no
+// read-modify-write); exporters read them concurrently. The extra last slot
+// absorbs metrics registered past the limit and is never exported.
+struct Metrics::Shard
+{
+    array<atomic<uint64_t>, MaxCounters + 1> counters{};
+    array<array<atomic<uint64_t>, NumBuckets + 1>, MaxHistograms + 1> buckets{};
+    array<atomic<uint64_t>, MaxHistograms + 1> sum_nanos{};
+};
+
+struct Metrics::Registry
+{
+    mutex lock;
+    vector<pair<string, string>> counters; // Name, help text
+    vector<pair<string, string>> histograms;
+    vector<Shard *> shards; // Live threads
+    Shard retired;          // Folded in from threads that have exited
+};
+
+struct Metrics::Totals
+{
+    vector<pair<string, string>> counter_names;
+    vector<pair<string, string>> histogram_names;
+    vector<uint64_t> counters;
+    vector<array<uint64_t, NumBuckets + 1>> buckets;
+    vector<uint64_t> sum_nanos;
+};
+
+// Static Helper Functions
+static void increment(atomic<uint64_t> &value, uint64_t amount)
+{
+    value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+static size_t bucketIndex(uint64_t nanos)
+{
+    uint64_t bound = 1000; // 1us
+    size_t bucket = 0;
+    while (bucket < Metrics::NumBuckets && nanos > bound)
+    {
+        bound <<= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static double bucketBound(size_t bucket)
+{
+    return 1e-6 * double(uint64_t(1) << bucket);
+}
+
+// Upper bound of the bucket holding the q-quantile; -1 when it is the +Inf bucket
+static double estimateQuantile(const array<uint64_t, Metrics::NumBuckets + 1> &buckets, uint64_t count, double q)
+{
+    uint64_t rank = max<uint64_t>(1, uint64_t(ceil(q * count))), seen = 0;
+    for (size_t i = 0; i < Metrics::NumBuckets; i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return bucketBound(i);
+    }
+    return -1;
+}
+
+Metrics::Registry &Metrics::registry()
+{
+    static Registry *instance = new Registry(); // Never destroyed, threads may exit after main returns
+    return *instance;
+}
+
+Metrics::Shard &Metrics::localShard()
+{
+    // Registers the thread's shard on first use and folds it into the retired totals on exit
+    struct Owner
+    {
+        Shard *shard = new Shard();
+
+        Owner()
+        {
+            lock_guard<mutex> lock(registry().lock);
+            registry().shards.push_back(shard);
+        }
+
+        ~Owner()
+        {
+            Registry &reg = registry();
+            lock_guard<mutex> lock(reg.lock);
+            for (size_t i = 0; i <= MaxCounters; i++)
+            {
+                increment(reg.retired.counters[i], shard->counters[i].load(memory_order_relaxed));
+            }
+            for (size_t h = 0; h <= MaxHistograms; h++)
+            {
+                for (size_t b = 0; b <= NumBuckets; b++)
+                {
+                    increment(reg.retired.buckets[h][b], shard->buckets[h][b].load(memory_order_relaxed));
+                }
+                increment(reg.retired.sum_nanos[h], shard->sum_nanos[h].load(memory_order_relaxed));
+            }
+            reg.shards.erase(find(reg.shards.begin(), reg.shards.end(), shard));
+            delete shard;
+        }
+    };
+
+    thread_local Owner owner;
+    return *owner.shard;
+}
+
+// Recording
+void Metrics::Counter::add(uint64_t value) const
+{
+    increment(localShard().counters[id], value);
+}
+
+void Metrics::Histogram::observe(double seconds) const
+{
+    uint64_t nanos = seconds > 0 ? uint64_t(seconds * 1e9) : 0;
+    Shard &shard = localShard();
+    increment(shard.buckets[id][bucketIndex(nanos)], 1);
+    increment(shard.sum_nanos[id], nanos);
+}
+
+// Registration
+Metrics::Counter Metrics::counter(const string &name, const string &help)
+{
+    Registry &reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    for (size_t i = 0; i < reg.counters.size(); i++)
+    {
+        if (reg.counters[i].first == name)
+            return Counter(i);
+    }
+    if (reg.counters.size() == MaxCounters)
+    {
+        cerr << "Warning: too many counters, " << name << " is not exported." << endl;
+        return Counter(MaxCounters);
+    }
+    reg.counters.emplace_back(name, help);
+    return Counter(reg.counters.size() - 1);
+}
+
+Metrics::Histogram Metrics::histogram(const string &name, const string &help)
+{
+    Registry &reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    for (size_t i = 0; i < reg.histograms.size(); i++)
+    {
+        if (reg.histograms[i].first == name)
+            return Histogram(i);
+    }
+    if (reg.histograms.size() == MaxHistograms)
+    {
+        cerr << "Warning: too many histograms, " << name << " is not exported." << endl;
+        return Histogram(MaxHistograms);
+    }
+    reg.histograms.emplace_back(name, help);
+    return Histogram(reg.histograms.size() - 1);
+}
+
+// Export
+Metrics::Totals Metrics::collect()
+{
+    Registry &reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+
+    Totals totals;
+    totals.counter_names = reg.counters;
+    totals.histogram_names = reg.histograms;
+    totals.counters.assign(reg.counters.size(), 0);
+    totals.buckets.assign(reg.histograms.size(), {});
+    totals.sum_nanos.assign(reg.histograms.size(), 0);
+
+    vector<const Shard *> shards(reg.shards.begin(), reg.shards.end());
+    shards.push_back(&reg.retired);
+    for (const Shard *shard : shards)
+    {
+        for (size_t i = 0; i < totals.counters.size(); i++)
+        {
+            totals.counters[i] += shard->counters[i].load(memory_order_relaxed);
+        }
+        for (size_t h = 0; h < totals.buckets.size(); h++)
+        {
+            for (size_t b = 0; b <= NumBuckets; b++)
+            {
+                totals.buckets[h][b] += shard->buckets[h][b].load(memory_order_relaxed);
+            }
+            totals.sum_nanos[h] += shard->sum_nanos[h].load(memory_order_relaxed);
+        }
+    }
+    return totals;
+}
+
+string Metrics::toJson()
+{
+    Totals totals = collect();
+    ostringstream out;
+    out << setprecision(9);
+
+    out << "{\n  \"counters\": {";
+    for (size_t i = 0; i < totals.counters.size(); i++)
+    {
+        out << (i ? "," : "") << "\n    \"" << totals.counter_names[i].first << "\": " << totals.counters[i];
+    }
+    out << "\n  },\n  \"bucket_bounds_seconds\": [";
+    for (size_t b = 0; b < NumBuckets; b++)
+    {
+        out << (b ? ", " : "") << bucketBound(b);
+    }
+    out << "],\n  \"histograms\": {";
+    for (size_t h = 0; h < totals.buckets.size(); h++)
+    {
+        const auto &buckets = totals.buckets[h];
+        uint64_t count = accumulate(buckets.begin(), buckets.end(), uint64_t(0));
+        double sum = totals.sum_nanos[h] / 1e9;
+
+        out << (h ? "," : "") << "\n    \"" << totals.histogram_names[h].first << "\": {\"count\": " << count
+            << ", \"sum_seconds\": " << sum << ", \"mean_seconds\": " << (count ? sum / count : 0.0);
+        for (double q : {0.5, 0.9, 0.99})
+        {
+            double bound = count ? estimateQuantile(buckets, count, q) : 0.0;
+            out << ", \"p" << int(q * 100) << "_seconds\": ";
+            if (bound < 0)
+                out << "null";
+            else
+                out << bound;
+        }
+        out << ", \"buckets\": [";
+        for (size_t b = 0; b <= NumBuckets; b++)
+        {
+            out << (b ? ", " : "") << buckets[b];
+        }
+        out << "]}";
+    }
+    out << "\n  }\n}\n";
+    return out.str();
+}
+
+string Metrics::toPrometheus()
+{
+    Totals totals = collect();
+    ostringstream out;
+    out << setprecision(9);
+
+    for (size_t i = 0; i < totals.counters.size(); i++)
+    {
+        const auto &name = totals.counter_names[i];
+        out << "# HELP " << name.first << " " << name.second << "\n"
+            << "# TYPE " << name.first << " counter\n"
+            << name.first << " " << totals.counters[i] << "\n";
+    }
+
+    for (size_t h = 0; h < totals.buckets.size(); h++)
+    {
+        const auto &name = totals.histogram_names[h];
+        out << "# HELP " << name.first << " " << name.second << "\n"
+            << "# TYPE " << name.first << " histogram\n";
+
+        // Prometheus buckets are cumulative
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < NumBuckets; b++)
+        {
+            cumulative += totals.buckets[h][b];
+            out << name.first << "_bucket{le=\"" << bucketBound(b) << "\"} " << cumulative << "\n";
+        }
+        cumulative += totals.buckets[h][NumBuckets];
+        out << name.first << "_bucket{le=\"+Inf\"} " << cumulative << "\n"
+            << name.first << "_sum " << totals.sum_nanos[h] / 1e9 << "\n"
+            << name.first << "_count " << cumulative << "\n";
+    }
+    return out.str();
+}
+
+bool Metrics::writeToFile(const string &file_path)
+{
+    ofstream file(file_path);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open metrics file " << file_path << " for writing." << endl;
+        return false;
+    }
+
+    bool json = file_path.size() >= 5 && file_path.compare(file_path.size() - 5, 5, ".json") == 0;
+    file << (json ? toJson() : toPrometheus());
+    return true;
+}
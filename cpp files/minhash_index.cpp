@@ -0,0 +1,179 @@
+#include "minhash_index.h"
+#include "memory_accounting.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Static Helper Functions
+static uint64_t mix64(uint64_t x)
+{
+    // splitmix64 finalizer, gives independent-looking hashes per seed
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+MinHashIndex::MinHashIndex(int num_bands, int rows_per_band)
+    : num_bands(num_bands), rows_per_band(rows_per_band), band_buckets(num_bands)
+{
+}
+
+uint64_t MinHashIndex::hashToken(const string &token, int hash_index) const
+{
+    return mix64(hash<string>{}(token) ^ mix64(hash_index));
+}
+
+uint64_t MinHashIndex::bandKey(const vector<uint64_t> &signature, int band) const
+{
+    uint64_t key = mix64(band);
+    for (int r = 0; r < rows_per_band; r++)
+    {
+        key = mix64(key ^ signature[band * rows_per_band + r]);
+    }
+    return key;
+}
+
+void MinHashIndex::insertIntoBuckets(const string &user_id, const vector<uint64_t> &signature)
+{
+    for (int band = 0; band < num_bands; band++)
+    {
+        band_buckets[band][bandKey(signature, band)].insert(user_id);
+    }
+}
+
+void MinHashIndex::removeFromBuckets(const string &user_id, const vector<uint64_t> &signature)
+{
+    for (int band = 0; band < num_bands; band++)
+    {
+        auto it = band_buckets[band].find(bandKey(signature, band));
+        if (it == band_buckets[band].end())
+        {
+            continue;
+        }
+
+        it->second.erase(user_id);
+        if (it->second.empty())
+        {
+            band_buckets[band].erase(it);
+        }
+    }
+}
+
+void MinHashIndex::updateUser(const string &user_id, const vector<string> &tokens)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::SimilarityIndex);
+    removeUser(user_id);
+
+    // An empty signature would put every token-less user in the same buckets
+    if (tokens.empty())
+    {
+        return;
+    }
+
+    vector<uint64_t> signature(num_bands * rows_per_band, numeric_limits<uint64_t>::max());
+    for (const auto &token : tokens)
+    {
+        for (size_t h = 0; h < signature.size(); h++)
+        {
+            signature[h] = min(signature[h], hashToken(token, h));
+        }
+    }
+
+    insertIntoBuckets(user_id, signature);
+    signatures[user_id] = move(signature);
+}
+
+void MinHashIndex::addToken(const string &user_id, const string &token)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::SimilarityIndex);
+    auto it = signatures.find(user_id);
+    if (it == signatures.end())
+    {
+        updateUser(user_id, {token});
+        return;
+    }
+
+    // Only re-bucket when one of the minimums actually changes
+    vector<uint64_t> signature = it->second;
+    bool changed = false;
+    for (size_t h = 0; h < signature.size(); h++)
+    {
+        uint64_t value = hashToken(token, h);
+        if (value < signature[h])
+        {
+            signature[h] = value;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        removeFromBuckets(user_id, it->second);
+        insertIntoBuckets(user_id, signature);
+        it->second = move(signature);
+    }
+}
+
+void MinHashIndex::removeUser(const string &user_id)
+{
+    auto it = signatures.find(user_id);
+    if (it != signatures.end())
+    {
+        removeFromBuckets(user_id, it->second);
+        signatures.erase(it);
+    }
+}
+
+void MinHashIndex::clear()
+{
+    signatures.clear();
+    for (auto &buckets : band_buckets)
+    {
+        buckets.clear();
+    }
+}
+
+vector<string> MinHashIndex::query(const string &user_id, size_t max_candidates) const
+{
+    vector<string> candidates;
+    auto it = signatures.find(user_id);
+    if (it == signatures.end())
+    {
+        return candidates;
+    }
+
+    // Count in how many bands each candidate collides with the query user
+    unordered_map<string, int> collisions;
+    for (int band = 0; band < num_bands; band++)
+    {
+        auto bucket = band_buckets[band].find(bandKey(it->second, band));
+        if (bucket == band_buckets[band].end())
+        {
+            continue;
+        }
+        for (const auto &candidate : bucket->second)
+        {
+            if (candidate != user_id)
+            {
+                collisions[candidate]++;
+            }
+        }
+    }
+
+    vector<pair<int, string>> ranked;
+    ranked.reserve(collisions.size());
+    for (const auto &entry : collisions)
+    {
+        ranked.emplace_back(-entry.second, entry.first);
+    }
+    sort(ranked.begin(), ranked.end());
+
+    for (const auto &entry : ranked)
+    {
+        if (max_candidates > 0 && candidates.size() >= max_candidates)
+            break;
+        candidates.push_back(entry.second);
+    }
+    return candidates;
+}
@@ -0,0 +1,21 @@
+#include "parse_utilities.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+bool ParseUtilities::parseCount(const string &field, size_t &count)
+{
+    if (field.empty() || !all_of(field.begin(), field.end(), [](unsigned char c) { return isdigit(c); }))
+    {
+        return false;
+    }
+    try
+    {
+        count = stoul(field);
+    }
+    catch (const exception &e)
+    {
+        return false;
+    }
+    return count > 0;
+}
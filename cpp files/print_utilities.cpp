@@ -8,27 +8,15 @@ int PrintUtilities::g_currentStart = 0;
 
 // Function to print top influencers
 void PrintUtilities::printResults(ConnectionManager &cm,
-                                  const unordered_map<string, double> &pagerank,
                                   const vector<vector<User *>> &communities)
 {
     cout << "Top 5 Influencers:" << endl;
-    vector<pair<string, double>> top_influencers;
 
-    // Collecting pagerank data into a vector
-    for (const auto &pair : pagerank)
+    // Read straight from the PageRank leaderboard
+    for (const auto &influencer : cm.getTopUsers(ConnectionManager::Centrality::PageRank, 5))
     {
-        top_influencers.emplace_back(pair.first, pair.second);
-    }
-
-    // Sorting the influencers by rank
-    sort(top_influencers.begin(), top_influencers.end(),
-         [](const auto &a, const auto &b) { return a.second > b.second; });
-
-    // Displaying the top influencers
-    for (size_t i = 0; i < 5 && i < top_influencers.size(); ++i)
-    {
-        cout << "User: " << cm.getUser(top_influencers[i].first)->getName()
-             << ", Influence: " << top_influencers[i].second << endl;
+        cout << "User: " << influencer.first->getName()
+             << ", Influence: " << influencer.second << endl;
     }
 
     cout << "\nCommunities:" << endl;
@@ -58,8 +46,8 @@ void PrintUtilities::printRecommendedCommunities(const vector<vector<User *>> &c
         bool is_match = false;
         for (User *user : community)
         {
-            if (user->getCategory() == new_user->getCategory() &&
-                user->getBranch() == new_user->getBranch())
+            if (user->getCategoryCode() == new_user->getCategoryCode() &&
+                user->getBranchCode() == new_user->getBranchCode())
             {
                 is_match = true;
                 break;
@@ -92,10 +80,10 @@ void PrintUtilities::printRecommendedConnections(const vector<pair<User *, User
     {
         const auto &pair = recommendations[i];
 
-        if ((pair.first->getCategory() == new_user->getCategory() &&
-             pair.first->getBranch() == new_user->getBranch()) ||
-            (pair.second->getCategory() == new_user->getCategory() &&
-             pair.second->getBranch() == new_user->getBranch()))
+        if ((pair.first->getCategoryCode() == new_user->getCategoryCode() &&
+             pair.first->getBranchCode() == new_user->getBranchCode()) ||
+            (pair.second->getCategoryCode() == new_user->getCategoryCode() &&
+             pair.second->getBranchCode() == new_user->getBranchCode()))
         {
 
             if (skipped < g_currentStart)
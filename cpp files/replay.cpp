@@ -0,0 +1,346 @@
+#include "connection_manager.h"
+#include "login_manager.h"
+#include "parse_utilities.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Workload replay: executes a file of operations against ConnectionManager and
+// LoginManager without any prompts and reports latency percentiles per
+// operation and the overall throughput.
+//
+//   replay <operations file> [--repeat 1] [--output replay_results.json]
+//          [--work-dir <dir>] [--verbose]
+//
+// One operation per line, fields separated by tabs (or by spaces when no
+// field contains a space); empty lines and lines starting with '#' are skipped:
+//
+//   REGISTER <name> <id> <password> <category> <influence> <branch>
+//   LOGIN <id> <password>
+//   CONNECT <id> <other id>
+//   DISCONNECT <id> <other id>
+//   RECOMMEND <id> [k]
+//   CONNECTIONS <id>
+//   PATH <id> <other id>
+//   DISTANCE <id> <other id>
+//   CENTRALITY <pagerank|betweenness|closeness> [k]
+//
+// As in service mode, mutations take the manager's write lock, queries its
+// read lock, and files are written by the background persistence thread.
+
+struct OperationStats
+{
+    vector<double> seconds;
+    size_t failures = 0;
+};
+
+// Static Helper Functions
+static vector<string> splitFields(const string &line)
+{
+    vector<string> fields;
+    stringstream ss(line);
+    string field;
+
+    if (line.find('\t') != string::npos)
+    {
+        while (getline(ss, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+    }
+    else
+    {
+        while (ss >> field)
+        {
+            fields.push_back(field);
+        }
+    }
+    return fields;
+}
+
+static bool isValidOperation(const vector<string> &fields)
+{
+    static const unordered_map<string, pair<size_t, size_t>> arity = {
+        {"REGISTER", {7, 7}}, {"LOGIN", {3, 3}}, {"CONNECT", {3, 3}}, {"DISCONNECT", {3, 3}},
+        {"RECOMMEND", {2, 3}}, {"CONNECTIONS", {2, 2}}, {"PATH", {3, 3}}, {"DISTANCE", {3, 3}}, {"CENTRALITY", {2, 3}}};
+
+    auto it = arity.find(fields[0]);
+    return it != arity.end() && fields.size() >= it->second.first && fields.size() <= it->second.second;
+}
+
+static bool loadOperations(const string &file_path, vector<vector<string>> &operations)
+{
+    ifstream file(file_path);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open operations file " << file_path << endl;
+        return false;
+    }
+
+    string line;
+    size_t line_number = 0;
+    while (getline(file, line))
+    {
+        line_number++;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        vector<string> fields = splitFields(line);
+        if (fields.empty() || fields[0][0] == '#')
+            continue;
+
+        if (!isValidOperation(fields))
+        {
+            cerr << "Skipping invalid operation on line " << line_number << ": " << line << endl;
+            continue;
+        }
+        operations.push_back(fields);
+    }
+    return true;
+}
+
+// Runs one operation; false when it was rejected (unknown user, duplicate ID, ...)
+static bool execute(const vector<string> &fields, ConnectionManager &cm, LoginManager &login_manager)
+{
+    const string &command = fields[0];
+
+    if (command == "REGISTER")
+    {
+        double influence;
+        try
+        {
+            influence = stod(fields[5]);
+        }
+        catch (const exception &e)
+        {
+            return false;
+        }
+        auto lock = cm.lockForWrite();
+        return login_manager.registerUser(fields[1], fields[2], fields[3], fields[4], influence, fields[6]);
+    }
+
+    if (command == "LOGIN")
+    {
+        auto lock = cm.lockForRead();
+        return login_manager.login(fields[1], fields[2]) != nullptr;
+    }
+
+    if (command == "CONNECT" || command == "DISCONNECT")
+    {
+        auto lock = cm.lockForWrite();
+        User *user = cm.getUser(fields[1]);
+        User *other = cm.getUser(fields[2]);
+        if (!user || !other || user == other)
+            return false;
+
+        if (command == "CONNECT")
+        {
+            if (cm.isValidConnection(user->getID(), other->getID()))
+                return false;
+            cm.addConnection(user, other);
+            return true;
+        }
+        if (!cm.isValidConnection(user->getID(), other->getID()))
+            return false;
+        cm.removeConnection(user, other);
+        return true;
+    }
+
+    if (command == "RECOMMEND")
+    {
+        size_t k = 5;
+        if (fields.size() >= 3 && !ParseUtilities::parseCount(fields[2], k))
+            return false;
+
+        // Same top-k cut as the server's RECOMMEND
+        auto lock = cm.lockForRead();
+        User *user = cm.getUser(fields[1]);
+        if (!user)
+            return false;
+        vector<pair<User *, User *>> recommendations = cm.recommendConnectionsForNewUser(user);
+        recommendations.resize(min(k, recommendations.size()));
+        return true;
+    }
+
+    if (command == "CONNECTIONS")
+    {
+        auto lock = cm.lockForRead();
+        User *user = cm.getUser(fields[1]);
+        if (!user)
+            return false;
+        cm.getConnections(user);
+        return true;
+    }
+
+    if (command == "PATH" || command == "DISTANCE")
+    {
+        // As in the server, the search runs on the published graph after the lock is released
+        shared_ptr<const DenseGraph> graph;
+        shared_ptr<const DistanceOracle> oracle;
+        {
+            auto lock = cm.lockForRead();
+            if (!cm.getUser(fields[1]) || !cm.getUser(fields[2]))
+                return false;
+            if (command == "PATH")
+                graph = cm.getDenseGraph();
+            else
+                oracle = cm.getDistanceOracle();
+        }
+
+        if (graph)
+            return !ConnectionManager::findShortestPath(*graph, fields[1], fields[2]).empty();
+        return ConnectionManager::getDistance(*oracle, fields[1], fields[2]) >= 0;
+    }
+
+    // CENTRALITY
+    const string &metric = fields[1];
+    if (metric != "pagerank" && metric != "betweenness" && metric != "closeness")
+        return false;
+    size_t k = 5;
+    if (fields.size() >= 3 && !ParseUtilities::parseCount(fields[2], k))
+        return false;
+
+    auto lock = cm.lockForRead();
+    cm.getTopUsers(metric == "pagerank"      ? ConnectionManager::Centrality::PageRank
+                   : metric == "betweenness" ? ConnectionManager::Centrality::Betweenness
+                                             : ConnectionManager::Centrality::Closeness,
+                   k);
+    return true;
+}
+
+static double percentile(const vector<double> &sorted, double q)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(ceil(q * sorted.size()));
+    return sorted[min(sorted.size(), max<size_t>(rank, 1)) - 1];
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: replay <operations file> [--repeat N] [--output file.json] [--work-dir dir] [--verbose]" << endl;
+        return 1;
+    }
+
+    string operations_file = filesystem::absolute(argv[1]).string();
+    int repeat = 1;
+    string output_file = "replay_results.json";
+    string work_dir;
+    bool verbose = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        string flag = argv[i];
+        if (flag == "--verbose")
+            verbose = true;
+        else if (i + 1 < argc && flag == "--repeat")
+            repeat = max(1, atoi(argv[++i]));
+        else if (i + 1 < argc && flag == "--output")
+            output_file = argv[++i];
+        else if (i + 1 < argc && flag == "--work-dir")
+            work_dir = argv[++i];
+        else
+        {
+            cerr << "Unknown option: " << flag << endl;
+            return 1;
+        }
+    }
+    output_file = filesystem::absolute(output_file).string();
+
+    vector<vector<string>> operations;
+    if (!loadOperations(operations_file, operations))
+        return 1;
+
+    // A work directory starts every replay from a copy of the current data files
+    if (!work_dir.empty())
+    {
+        filesystem::path source = filesystem::current_path();
+        filesystem::remove_all(work_dir);
+        filesystem::create_directories(work_dir);
+        for (const char *name : {"user_data.csv", "connections.bin", "adjacency_matrix.csv", "analytics_snapshot.bin"})
+        {
+            if (filesystem::exists(source / name))
+                filesystem::copy_file(source / name, filesystem::path(work_dir) / name);
+        }
+        filesystem::current_path(work_dir);
+    }
+
+    // The managers report every step on stdout; keep only the summary unless asked
+    streambuf *stdout_buffer = cout.rdbuf();
+    if (!verbose)
+        cout.rdbuf(nullptr);
+
+    auto startup_begin = chrono::steady_clock::now();
+    ConnectionManager cm("user_data.csv");
+    LoginManager login_manager(cm);
+    double startup_seconds = chrono::duration<double>(chrono::steady_clock::now() - startup_begin).count();
+    cm.startBackgroundPersistence();
+
+    map<string, OperationStats> stats;
+    auto replay_begin = chrono::steady_clock::now();
+    for (int run = 0; run < repeat; run++)
+    {
+        for (const vector<string> &fields : operations)
+        {
+            auto start = chrono::steady_clock::now();
+            bool succeeded = execute(fields, cm, login_manager);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            OperationStats &entry = stats[fields[0]];
+            entry.seconds.push_back(seconds);
+            if (!succeeded)
+                entry.failures++;
+        }
+    }
+    double replay_seconds = chrono::duration<double>(chrono::steady_clock::now() - replay_begin).count();
+    cm.stopBackgroundPersistence();
+
+    cout.rdbuf(stdout_buffer);
+    cout.clear();
+
+    // Summary table, latencies in milliseconds
+    size_t total_operations = 0;
+    cout << left << setw(12) << "operation" << right << setw(8) << "count" << setw(9) << "failed"
+         << setw(11) << "p50_ms" << setw(11) << "p90_ms" << setw(11) << "p99_ms" << setw(11) << "max_ms" << endl;
+    for (auto &entry : stats)
+    {
+        vector<double> &seconds = entry.second.seconds;
+        sort(seconds.begin(), seconds.end());
+        total_operations += seconds.size();
+        cout << left << setw(12) << entry.first << right << setw(8) << seconds.size() << setw(9) << entry.second.failures
+             << fixed << setprecision(3) << setw(11) << percentile(seconds, 0.5) * 1e3
+             << setw(11) << percentile(seconds, 0.9) * 1e3 << setw(11) << percentile(seconds, 0.99) * 1e3
+             << setw(11) << seconds.back() * 1e3 << endl;
+    }
+    double throughput = total_operations / max(replay_seconds, 1e-9);
+    cout << "Startup " << setprecision(3) << startup_seconds << " s, replayed " << total_operations << " operations in "
+         << replay_seconds << " s (" << setprecision(1) << throughput << " ops/s)" << endl;
+
+    // Machine-readable output, for comparing builds
+    ofstream json(output_file);
+    if (!json.is_open())
+    {
+        cerr << "Error: Could not open " << output_file << " for writing." << endl;
+        return 1;
+    }
+    json << setprecision(9);
+    json << "{\n  \"operations_file\": \"" << operations_file << "\", \"repeat\": " << repeat
+         << ", \"startup_seconds\": " << startup_seconds << ", \"replay_seconds\": " << replay_seconds
+         << ", \"operations\": " << total_operations << ", \"ops_per_second\": " << throughput << ",\n  \"latency\": [";
+    bool first = true;
+    for (const auto &entry : stats)
+    {
+        const vector<double> &seconds = entry.second.seconds;
+        json << (first ? "" : ",") << "\n    {\"operation\": \"" << entry.first << "\", \"count\": " << seconds.size()
+             << ", \"failed\": " << entry.second.failures
+             << ", \"mean_seconds\": " << accumulate(seconds.begin(), seconds.end(), 0.0) / seconds.size()
+             << ", \"p50_seconds\": " << percentile(seconds, 0.5) << ", \"p90_seconds\": " << percentile(seconds, 0.9)
+             << ", \"p99_seconds\": " << percentile(seconds, 0.99) << ", \"max_seconds\": " << seconds.back() << "}";
+        first = false;
+    }
+    json << "\n  ]\n}\n";
+    cout << "Wrote results to " << output_file << endl;
+    return 0;
+}
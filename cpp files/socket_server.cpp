@@ -0,0 +1,437 @@
+#include "socket_server.h"
+#include "metrics.h"
+#include "trace.h"
+#include "memory_accounting.h"
+#include "parse_utilities.h"
+#include <bits/stdc++.h>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Metrics
+static const Metrics::Histogram request_seconds = Metrics::histogram("server_request_seconds", "Requests served, lock waits included");
+
+SocketServer::SocketServer(ConnectionManager &cm, LoginManager &login_manager, const string &socket_path)
+    : cm(cm), login_manager(login_manager), socket_path(socket_path)
+{
+}
+
+vector<string> SocketServer::splitFields(const string &line)
+{
+    vector<string> fields;
+    stringstream ss(line);
+    string field;
+
+    if (line.find('\t') != string::npos)
+    {
+        while (getline(ss, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+    }
+    else
+    {
+        while (ss >> field)
+        {
+            fields.push_back(field);
+        }
+    }
+    return fields;
+}
+
+bool SocketServer::isMutation(const vector<string> &fields)
+{
+    return !fields.empty() && (fields[0] == "REGISTER" || fields[0] == "CONNECT" || fields[0] == "DISCONNECT");
+}
+
+bool SocketServer::isGraphQuery(const vector<string> &fields)
+{
+    return fields.size() == 2 && (fields[0] == "PATH" || fields[0] == "DISTANCE");
+}
+
+string SocketServer::handleRequest(const vector<string> &fields, User *&session_user, bool &close_client)
+{
+    if (fields.empty())
+    {
+        return "ERR empty request";
+    }
+
+    const string &command = fields[0];
+
+    if (command == "QUIT")
+    {
+        close_client = true;
+        return "OK bye";
+    }
+
+    if (command == "SHUTDOWN")
+    {
+        close_client = true;
+        running = false; // The accept loop is woken up once this reply is sent
+        return "OK shutting down";
+    }
+
+    if (command == "METRICS" && fields.size() == 2)
+    {
+        return Metrics::writeToFile(fields[1]) ? "OK wrote " + fields[1] : "ERR could not write " + fields[1];
+    }
+
+    if (command == "MEMORY")
+    {
+        if (!MemoryAccounting::isEnabled())
+        {
+            return "ERR memory tracking is disabled in this build";
+        }
+        string response = "OK";
+        for (const auto &usage : MemoryAccounting::getUsage())
+        {
+            response += " " + string(usage.name) + "=" + to_string(usage.live_bytes / 1024) + "/" +
+                        to_string(usage.peak_bytes / 1024);
+        }
+        return response;
+    }
+
+    if (command == "LOGIN" && fields.size() == 3)
+    {
+        session_user = login_manager.login(fields[1], fields[2]);
+        return session_user ? "OK " + session_user->getID() : "ERR invalid ID or password";
+    }
+
+    if (command == "REGISTER" && fields.size() == 7)
+    {
+        double influence;
+        try
+        {
+            influence = stod(fields[5]);
+        }
+        catch (const exception &e)
+        {
+            return "ERR invalid influence";
+        }
+
+        if (!login_manager.registerUser(fields[1], fields[2], fields[3], fields[4], influence, fields[6]))
+        {
+            return "ERR user ID already exists";
+        }
+        session_user = login_manager.getUserById(fields[2]);
+        return "OK " + fields[2];
+    }
+
+    if (command == "CENTRALITY" && fields.size() >= 2)
+    {
+        const string &metric = fields[1];
+        if (metric != "pagerank" && metric != "betweenness" && metric != "closeness")
+        {
+            return "ERR unknown metric";
+        }
+        size_t k = 5;
+        if (fields.size() >= 3 && !ParseUtilities::parseCount(fields[2], k))
+        {
+            return "ERR invalid k";
+        }
+
+        // Served from the metric's leaderboard, refreshed in the background after edits
+        auto top_users = cm.getTopUsers(metric == "pagerank"      ? ConnectionManager::Centrality::PageRank
+                                        : metric == "betweenness" ? ConnectionManager::Centrality::Betweenness
+                                                                  : ConnectionManager::Centrality::Closeness,
+                                        k);
+
+        string response = "OK";
+        for (const auto &entry : top_users)
+        {
+            response += " " + entry.first->getID() + "=" + to_string(entry.second);
+        }
+        return response;
+    }
+
+    // Everything below acts on the logged-in user
+    if (!session_user)
+    {
+        return "ERR login required";
+    }
+
+    if (command == "CONNECTIONS")
+    {
+        string response = "OK";
+        for (const auto &connection : cm.getConnections(session_user))
+        {
+            response += " " + connection.first->getID() + "=" + to_string(connection.second);
+        }
+        return response;
+    }
+
+    if ((command == "CONNECT" || command == "DISCONNECT") && fields.size() == 2)
+    {
+        User *other = cm.getUser(fields[1]);
+        if (!other || other == session_user)
+        {
+            return "ERR unknown user";
+        }
+
+        if (command == "CONNECT")
+        {
+            if (cm.isValidConnection(session_user->getID(), other->getID()))
+            {
+                return "ERR already connected";
+            }
+            cm.addConnection(session_user, other);
+            return "OK connected " + other->getID();
+        }
+
+        if (!cm.isValidConnection(session_user->getID(), other->getID()))
+        {
+            return "ERR not connected";
+        }
+        cm.removeConnection(session_user, other);
+        return "OK disconnected " + other->getID();
+    }
+
+    if (command == "RECOMMEND")
+    {
+        size_t k = 5;
+        if (fields.size() >= 2 && !ParseUtilities::parseCount(fields[1], k))
+        {
+            return "ERR invalid k";
+        }
+        vector<pair<User *, User *>> recommendations = cm.recommendConnectionsForNewUser(session_user);
+
+        string response = "OK";
+        for (size_t i = 0; i < k && i < recommendations.size(); i++)
+        {
+            response += " " + recommendations[i].second->getID();
+        }
+        return response;
+    }
+
+    return "ERR unknown command";
+}
+
+string SocketServer::handleGraphQuery(const vector<string> &fields, User *session_user)
+{
+    // The read lock only covers resolving the users and fetching the published graph;
+    // the search itself runs on that immutable copy, so writers are not kept waiting
+    string from_id;
+    shared_ptr<const DenseGraph> graph;
+    shared_ptr<const DistanceOracle> oracle;
+    {
+        auto lock = cm.lockForRead();
+        if (!session_user)
+        {
+            return "ERR login required";
+        }
+        if (!cm.getUser(fields[1]))
+        {
+            return "ERR unknown user";
+        }
+
+        from_id = session_user->getID();
+        if (fields[0] == "PATH")
+        {
+            graph = cm.getDenseGraph();
+        }
+        else
+        {
+            oracle = cm.getDistanceOracle();
+        }
+    }
+
+    if (graph)
+    {
+        vector<string> path = ConnectionManager::findShortestPath(*graph, from_id, fields[1]);
+        if (path.empty())
+        {
+            return "ERR not connected";
+        }
+
+        string response = "OK";
+        for (const string &user_id : path)
+        {
+            response += " " + user_id;
+        }
+        return response;
+    }
+
+    int hops = ConnectionManager::getDistance(*oracle, from_id, fields[1]);
+    if (hops < 0)
+    {
+        return "ERR not connected";
+    }
+    return "OK " + to_string(hops);
+}
+
+#ifndef _WIN32
+
+void SocketServer::serveClient(int client_fd)
+{
+    Trace::setThreadName("client " + to_string(client_fd));
+    User *session_user = nullptr;
+    bool close_client = false;
+    string buffer;
+    char chunk[4096];
+
+    while (!close_client)
+    {
+        ssize_t received = recv(client_fd, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+        {
+            break;
+        }
+        buffer.append(chunk, received);
+
+        // Handle every complete line in the buffer
+        size_t newline;
+        while (!close_client && (newline = buffer.find('\n')) != string::npos)
+        {
+            string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            string response;
+            try
+            {
+                Metrics::ScopedTimer timer(request_seconds);
+                Trace::Span span("request", "request");
+                vector<string> fields = splitFields(line);
+                if (isGraphQuery(fields))
+                {
+                    response = handleGraphQuery(fields, session_user);
+                }
+                else if (isMutation(fields))
+                {
+                    auto lock = cm.lockForWrite();
+                    response = handleRequest(fields, session_user, close_client);
+                }
+                else
+                {
+                    auto lock = cm.lockForRead();
+                    response = handleRequest(fields, session_user, close_client);
+                }
+
+                auto lock = cm.lockForRead();
+                cm.refreshAnalytics();
+            }
+            catch (const exception &e)
+            {
+                response = string("ERR ") + e.what();
+            }
+            response += "\n";
+
+            size_t sent = 0;
+            while (sent < response.size())
+            {
+                ssize_t n = send(client_fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                {
+                    close_client = true;
+                    break;
+                }
+                sent += n;
+            }
+        }
+    }
+
+    if (!running)
+    {
+        shutdown(listen_fd, SHUT_RDWR); // Wakes up the accept loop
+    }
+
+    {
+        lock_guard<mutex> lock(clients_mutex);
+        active_clients.erase(client_fd);
+    }
+    close(client_fd);
+}
+
+bool SocketServer::run()
+{
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        cerr << "Error: Could not create socket." << endl;
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        cerr << "Error: Socket path too long: " << socket_path << endl;
+        close(listen_fd);
+        return false;
+    }
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socket_path.c_str()); // Remove a stale socket from a previous run
+
+    if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        listen(listen_fd, 64) < 0)
+    {
+        cerr << "Error: Could not listen on " << socket_path << endl;
+        close(listen_fd);
+        return false;
+    }
+
+    cout << "Serving on " << socket_path << endl;
+    running = true;
+    cm.startBackgroundPersistence();
+    vector<thread> clients;
+
+    while (running)
+    {
+        int client_fd = accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break; // Listening socket was shut down
+        }
+        {
+            lock_guard<mutex> lock(clients_mutex);
+            active_clients.insert(client_fd);
+        }
+        clients.emplace_back(&SocketServer::serveClient, this, client_fd);
+    }
+
+    {
+        lock_guard<mutex> lock(clients_mutex);
+        for (int client_fd : active_clients)
+        {
+            shutdown(client_fd, SHUT_RDWR);
+        }
+    }
+
+    for (auto &client : clients)
+    {
+        client.join();
+    }
+
+    // Keep the last refresh so it ends up in the analytics snapshot
+    {
+        auto lock = cm.lockForRead();
+        cm.finishAnalytics();
+    }
+    cm.stopBackgroundPersistence();
+
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    return true;
+}
+
+#else
+
+void SocketServer::serveClient(int client_fd) {}
+
+bool SocketServer::run()
+{
+    cerr << "Service mode requires Unix domain sockets and is not available on this platform." << endl;
+    return false;
+}
+
+#endif
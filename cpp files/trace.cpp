@@ -0,0 +1,167 @@
+#include "trace.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+struct Trace::Event
+{
+    const char *name;
+    const char *category;
+    int64_t start_ns; // Since the trace started
+    int64_t duration_ns;
+};
+
+// Owned by the registry, so events of threads that have exited are still written
+struct Trace::ThreadBuffer
+{
+    mutex lock; // Only contended while the trace is being written
+    int thread_id;
+    string thread_name;
+    vector<Event> events;
+};
+
+struct Trace::Registry
+{
+    mutex lock;
+    string file_path;
+    chrono::steady_clock::time_point origin;
+    vector<unique_ptr<ThreadBuffer>> buffers;
+};
+
+atomic<bool> Trace::enabled{false};
+
+// Static Helper Functions
+static string escapeJson(const string &text)
+{
+    string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+Trace::Registry &Trace::registry()
+{
+    static Registry *instance = new Registry(); // Never destroyed, threads may exit after main returns
+    return *instance;
+}
+
+Trace::ThreadBuffer &Trace::localBuffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer)
+    {
+        Registry &reg = registry();
+        lock_guard<mutex> lock(reg.lock);
+        reg.buffers.push_back(make_unique<ThreadBuffer>());
+        buffer = reg.buffers.back().get();
+        buffer->thread_id = reg.buffers.size();
+        buffer->thread_name = "thread " + to_string(buffer->thread_id);
+    }
+    return *buffer;
+}
+
+int64_t Trace::now()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - registry().origin).count();
+}
+
+// Spans
+Trace::Span::Span(const char *name, const char *category) : name(name), category(category)
+{
+    if (isEnabled())
+    {
+        start_ns = now();
+    }
+}
+
+Trace::Span::~Span()
+{
+    if (start_ns < 0 || !isEnabled())
+    {
+        return;
+    }
+    int64_t end_ns = now();
+    ThreadBuffer &buffer = localBuffer();
+    lock_guard<mutex> lock(buffer.lock);
+    buffer.events.push_back({name, category, start_ns, end_ns - start_ns});
+}
+
+// Control
+void Trace::start(const string &file_path)
+{
+    Registry &reg = registry();
+    {
+        lock_guard<mutex> lock(reg.lock);
+        reg.file_path = file_path;
+        reg.origin = chrono::steady_clock::now();
+        for (auto &buffer : reg.buffers)
+        {
+            lock_guard<mutex> buffer_lock(buffer->lock);
+            buffer->events.clear();
+        }
+    }
+    enabled.store(true, memory_order_release);
+    setThreadName("main");
+}
+
+bool Trace::stop()
+{
+    if (!enabled.exchange(false))
+    {
+        return false;
+    }
+
+    Registry &reg = registry();
+    lock_guard<mutex> lock(reg.lock);
+    ofstream file(reg.file_path);
+    if (!file.is_open())
+    {
+        cerr << "Error: Could not open trace file " << reg.file_path << " for writing." << endl;
+        return false;
+    }
+
+    // Complete ("X") events in microseconds, plus a name for every thread row
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << fixed << setprecision(3);
+    bool first = true;
+    size_t num_events = 0;
+    for (auto &buffer : reg.buffers)
+    {
+        lock_guard<mutex> buffer_lock(buffer->lock);
+        file << (first ? "" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": "
+             << buffer->thread_id << ", \"args\": {\"name\": \"" << escapeJson(buffer->thread_name) << "\"}}";
+        first = false;
+
+        for (const Event &event : buffer->events)
+        {
+            file << ",\n{\"ph\": \"X\", \"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                 << "\", \"pid\": 1, \"tid\": " << buffer->thread_id << ", \"ts\": " << event.start_ns / 1000.0
+                 << ", \"dur\": " << event.duration_ns / 1000.0 << "}";
+        }
+        num_events += buffer->events.size();
+    }
+    file << "\n]}\n";
+
+    if (!file)
+    {
+        cerr << "Error: Failed to write trace file " << reg.file_path << endl;
+        return false;
+    }
+    cout << "Wrote " << num_events << " trace events to " << reg.file_path << endl;
+    return true;
+}
+
+void Trace::setThreadName(const string &name)
+{
+    if (!isEnabled())
+    {
+        return; // Threads only get a buffer while a trace is running
+    }
+    ThreadBuffer &buffer = localBuffer();
+    lock_guard<mutex> lock(buffer.lock);
+    buffer.thread_name = name;
+}
@@ -0,0 +1,79 @@
+#include "user_store.h"
+#include "user.h"
+#include "memory_accounting.h"
+#include <bits/stdc++.h>
+
+using namespace std;
+
+UserStore::UserStore() {}
+
+UserStore::~UserStore() {}
+
+string_view UserStore::storeString(const string &value)
+{
+    if (value.empty())
+    {
+        return string_view();
+    }
+
+    // Oversized strings get a dedicated block inserted before the current one,
+    // so the partially filled block stays last and keeps being used
+    if (value.size() > ArenaBlockSize)
+    {
+        unique_ptr<char[]> block(new char[value.size()]);
+        memcpy(block.get(), value.data(), value.size());
+        string_view view(block.get(), value.size());
+        arena_blocks.insert(arena_blocks.empty() ? arena_blocks.end() : arena_blocks.end() - 1, move(block));
+        return view;
+    }
+
+    if (arena_used + value.size() > ArenaBlockSize)
+    {
+        arena_blocks.emplace_back(new char[ArenaBlockSize]);
+        arena_used = 0;
+    }
+
+    char *dest = arena_blocks.back().get() + arena_used;
+    memcpy(dest, value.data(), value.size());
+    arena_used += value.size();
+    return string_view(dest, value.size());
+}
+
+uint32_t AttributeDictionary::findCode(string_view value) const
+{
+    auto it = codes.find(value);
+    return it != codes.end() ? it->second : NotFound;
+}
+
+uint32_t UserStore::intern(AttributeDictionary &dictionary, const string &value)
+{
+    uint32_t code = dictionary.findCode(value);
+    if (code != AttributeDictionary::NotFound)
+    {
+        return code;
+    }
+
+    // First occurrence: copy into the arena once and assign the next code
+    string_view stored = storeString(value);
+    code = dictionary.values.size();
+    dictionary.values.push_back(stored);
+    dictionary.codes[stored] = code;
+    return code;
+}
+
+User *UserStore::addUser(const string &name, const string &id, const string &password,
+                         const string &category, double influence, const string &branch)
+{
+    MemoryAccounting::Scope memory_scope(MemoryAccounting::Subsystem::Users);
+    uint32_t slot = ids.size();
+
+    names.push_back(storeString(name));
+    ids.push_back(id);
+    passwords.push_back(storeString(password));
+    category_codes.push_back(intern(category_dictionary, category));
+    influences.push_back(influence);
+    branch_codes.push_back(intern(branch_dictionary, branch));
+    handles.emplace_back(new User(this, slot));
+
+    return handles.back().get();
+}
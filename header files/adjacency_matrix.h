@@ -16,9 +16,11 @@ public:
     // Initialization
     void initializeBaseMatrix(const vector<User *> &users, const vector<vector<User *>> &communities);
     void addNewUser(const string &userId); // Add new user to matrix with zero connections
+    void addNewUsers(const vector<string> &userIds); // Bulk add, grows each row once and does not save
 
     // Connection Management
-    void updateConnection(const string &user1_id, const string &user2_id, const vector<vector<User *>> &communities);
+    void updateConnection(const string &user1_id, const string &user2_id, int community1, int community2,
+                          bool save_immediately = true); // Community indices (-1: none); pass false when batching, then call forceSave()
     void removeConnection(const string &user1_id, const string &user2_id);
     double calculateConnectionWeight(User *user1, User *user2, const vector<vector<User *>> &communities);
     double getConnectionWeight(const string &user1_id, const string &user2_id) const;
@@ -27,10 +29,12 @@ public:
     void saveToFile(); // Save matrix to CSV
     void loadFromFile(); // Load matrix from CSV
     void forceSave(); // Force save changes to file
+    void setDeferredSaves(bool deferred); // When set, changes are only written by forceSave()
 
     // Utility Functions
     const unordered_map<string, int> &getUserIndexMap() const;
     const vector<vector<double>> &getMatrix() const;
+    const vector<string> &getUserIds() const; // Row/column order of getMatrix()
     void printMatrix() const; // Print matrix (for debugging)
 
 private:
@@ -45,6 +49,7 @@ private:
     bool areInSameCommunity(const string &user1_id, const string &user2_id, const vector<vector<User *>> &communities) const;
 
     bool hasChanges = false; // Track changes for saving
+    bool deferredSaves = false; // A background writer calls forceSave() instead
 };
 
 #endif // ADJACENCY_MATRIX_H
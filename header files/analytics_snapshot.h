@@ -0,0 +1,27 @@
+#ifndef ANALYTICS_SNAPSHOT_H
+#define ANALYTICS_SNAPSHOT_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Compact binary snapshot of analytics results, tagged with the hash of the graph they were computed on
+class AnalyticsSnapshot
+{
+public:
+    uint64_t graph_hash = 0;
+
+    // Scores indexed by user position; an empty vector means "not computed"
+    vector<double> betweenness;
+    vector<double> closeness;
+    vector<double> pagerank;
+
+    // Communities as lists of user positions
+    vector<vector<uint32_t>> communities;
+
+    // File Operations
+    bool saveToFile(const string &file_path) const;
+    bool loadFromFile(const string &file_path); // False if missing, truncated or of another format version
+};
+
+#endif // ANALYTICS_SNAPSHOT_H
@@ -15,6 +15,7 @@ private:
     static void viewConnections(ConnectionManager &cm, User *user);
     static void addNewConnections(ConnectionManager &cm, User *user);
     static void removeConnection(ConnectionManager &cm, User *user);
+    static void findConnectionPath(ConnectionManager &cm, User *user);
 };
 
 #endif
\ No newline at end of file
@@ -3,7 +3,16 @@
 
 #include <bits/stdc++.h>
 #include "adjacency_matrix.h"
+#include "link_predictor.h"
+#include "minhash_index.h"
+#include "analytics_snapshot.h"
+#include "dense_graph.h"
+#include "distance_oracle.h"
+#include "edge_store.h"
+#include "graph_snapshot.h"
+#include "leaderboard.h"
 #include "user.h"
+#include "user_store.h"
 
 using namespace std;
 
@@ -18,41 +27,199 @@ public:
     unordered_map<string, double> calculateClosenessCentrality();
     unordered_map<string, double> calculatePageRank();
 
+    // Snapshot Analytics (pure functions of a snapshot, safe to run off the request path)
+    static unordered_map<string, double> calculateBetweennessCentrality(const GraphSnapshot &graph);
+    static unordered_map<string, double> calculateClosenessCentrality(const GraphSnapshot &graph);
+    static unordered_map<string, double> calculatePageRank(const GraphSnapshot &graph);
+
+    // Lazy Analytics (computed on first use, memoized per graph version)
+    const unordered_map<string, double> &getBetweennessCentrality();
+    const unordered_map<string, double> &getClosenessCentrality();
+    const unordered_map<string, double> &getPageRank();
+
+    // Leaderboards (top users per metric, kept up to date as scores change)
+    enum class Centrality
+    {
+        Betweenness,
+        Closeness,
+        PageRank
+    };
+    // Served from the last installed scores, which may be a graph version behind while a background
+    // refresh runs; computed synchronously only when there are no scores yet. No sorting of all users.
+    vector<pair<User *, double>> getTopUsers(Centrality metric, size_t k);
+
+    // Analytics Snapshots (reused on startup while the graph is unchanged)
+    uint64_t computeGraphHash() const; // Content hash of users and edges
+    bool saveAnalyticsSnapshot(const string &file_path);
+    bool loadAnalyticsSnapshot(const string &file_path); // False if missing or computed for another graph
+
+    // Graph Snapshots (copy-on-write, readers never block writers)
+    struct AnalyticsResults
+    {
+        unsigned long version = 0; // Graph version of the snapshot the scores were computed on
+        unordered_map<string, double> betweenness;
+        unordered_map<string, double> closeness;
+        unordered_map<string, double> pagerank;
+    };
+    shared_ptr<const GraphSnapshot> getSnapshot(); // Publishes a new snapshot if the graph changed
+    future<AnalyticsResults> computeAnalyticsInBackground();
+    bool installAnalytics(AnalyticsResults results); // False if the cached scores are already as new
+    void refreshAnalytics(); // Installs a finished background run, starts the next if the graph moved on (read lock held)
+    void finishAnalytics();  // Waits for a running refresh and installs it
+    shared_ptr<const DenseGraph> getDenseGraph(); // Dense-index view of the current snapshot, rebuilt when the graph changes
+
+    // Degrees of Separation (bidirectional BFS, only the two frontiers are explored)
+    vector<User *> findShortestPath(User *from, User *to); // From..to inclusive, empty if not connected
+    static vector<string> findShortestPath(const DenseGraph &graph, const string &from_id, const string &to_id); // Needs no lock
+
+    // Hop Distances (pruned landmark labels, updated incrementally as edges are added)
+    shared_ptr<const DistanceOracle> getDistanceOracle(); // For analytics that need many distances
+    int getDistance(User *from, User *to);                 // -1 if not connected
+    static int getDistance(const DistanceOracle &oracle, const string &from_id, const string &to_id); // Needs no lock
+
     // User Management
     vector<User *> getAllUsers();
     void addUser(User *new_user);
+    void addUsers(const vector<User *> &new_users); // Bulk onboarding: one community pass, one matrix save
+    User *createUser(const string &name, const string &id, const string &password,
+                     const string &category, double influence, const string &branch); // Allocates in the user store
     User *getUser(const string &id) const;
     void loadUserData(const string &file_path);
     void saveUserData(const string &file_path);
+    bool persistNewUsers(const vector<User *> &new_users); // Appends to the user file now, or queues the rows for the writer thread
     int getRandomPosition(int max); // For random selection of users
     double getLuminance(const string &color); // Utility to calculate luminance of a color
 
     // Connection Management
     vector<pair<User *, User *>> recommendConnectionsForNewUser(User *new_user);
+    size_t writeRecommendationsForAllUsers(const string &output_file, size_t top_k); // Parallel batch job, returns users written
     void addConnection(User *user1, User *user2);
     void removeConnection(User *user1, User *user2);
     void viewConnections(User *user);
+    vector<pair<User *, double>> getConnections(User *user) const; // Connections with weight >= 13, with weights
     bool isValidConnection(const string &user1_id, const string &user2_id);
     double getConnectionWeight(const string &user1_id, const string &user2_id) const;
 
+    // Structural Link Prediction (common neighbors, Jaccard, Adamic-Adar)
+    unordered_map<string, vector<LinkPredictor::LinkScore>> predictLinksForAllUsers(size_t top_k);
+    shared_ptr<const LinkPredictor> getLinkPredictor(); // Built on first use for each graph version
+
     // Community Detection
     vector<vector<User *>> detectCommunities();
+    const vector<vector<User *>> &getCommunities(); // Cached until the graph changes
+    unsigned long getGraphVersion() const { return graph_version; }
 
     // Graph Visualization
-    void visualizeGraph(const string &output_file, const unordered_map<string, double> &betweenness, const vector<vector<User *>> &communities);
+    void visualizeGraph(const string &output_file, const vector<vector<User *>> &communities);
+    void visualizeCommunities(const string &output_file, const unordered_set<int> &expanded_communities); // SVG overview
 
     // Initialize the Adjacency Matrix
     void initializeAdjacencyMatrix();
     void establishConnections();
 
+    // Similar-User Index (MinHash/LSH over attributes and neighbors)
+    void rebuildSimilarityIndex();
+
+    // Concurrency: sessions hold a read lock for queries and a write lock for mutations.
+    // Under either lock, getUser and getConnectionWeight are plain lookups that take no lock of their own.
+    // A DenseGraph or DistanceOracle fetched under the read lock stays valid after it is released.
+    shared_lock<shared_mutex> lockForRead() const { return shared_lock<shared_mutex>(graph_mutex); }
+    unique_lock<shared_mutex> lockForWrite() { return unique_lock<shared_mutex>(graph_mutex); }
+    void startBackgroundPersistence(); // Saves move off the request path onto one writer thread
+    void stopBackgroundPersistence();  // Flushes pending changes and joins the writer thread
+
 private:
     // User and Connection Data
+    UserStore user_store; // Owns every User handle and its attribute columns
     unordered_map<string, vector<string>> connections;
     vector<User *> users;
-    
+    unordered_map<string, User *> user_lookup; // User ID -> User for constant-time lookups
+    MinHashIndex similarity_index;             // Approximate similar-user candidates
+
+    // Cached Results (invalidated on graph changes)
+    unsigned long graph_version = 0;                                           // Bumped on every user/edge change
+    unsigned long communities_version = ~0UL;                                  // Graph version the cache was built for
+    vector<vector<User *>> cached_communities;
+    unordered_map<string, string> community_labels;                            // User ID -> canonical community label
+    unordered_map<string, int> community_index;                                // User ID -> position in cached_communities
+
+    struct RecommendationShard
+    {
+        mutex lock;
+        unordered_map<string, vector<pair<User *, User *>>> entries; // User ID -> ranked recommendations
+    };
+    array<RecommendationShard, 16> recommendation_cache; // Sharded by user slot so sessions rarely contend
+
+    struct CachedScores
+    {
+        unsigned long version = ~0UL; // Graph version the scores were computed for
+        unordered_map<string, double> scores;
+        Leaderboard leaderboard; // Same scores, ranked by user slot
+    };
+    CachedScores cached_betweenness;
+    CachedScores cached_closeness;
+    CachedScores cached_pagerank;
+
+    // Background Analytics (one run at a time on a snapshot, see refreshAnalytics)
+    mutex analytics_mutex;
+    future<AnalyticsResults> pending_analytics;
+    unsigned long analytics_version = ~0UL; // Graph version of the last started run
+
+    // Published Snapshot
+    shared_ptr<const GraphSnapshot> snapshot;
+    unordered_set<string> dirty_adjacency; // Users whose neighbor block must be copied into the next snapshot
+    bool snapshot_users_changed = true;    // User list changed (or full rebuild needed)
+    shared_ptr<const DenseGraph> dense_graph;
+    shared_ptr<const DistanceOracle> distance_oracle;
+    shared_ptr<const LinkPredictor> link_predictor;
+    unsigned long link_predictor_version = ~0UL; // Graph version link_predictor was built from
+
+    // Locks (graph_mutex guards users and edges; the others guard caches filled by readers)
+    mutable shared_mutex graph_mutex;
+    mutex communities_mutex;
+    mutex scores_mutex;
+    mutex snapshot_mutex;
+    mutex dense_graph_mutex;
+    mutex distance_oracle_mutex;
+    mutex link_predictor_mutex;
+
+    // Background Persistence (a single writer thread, bursts of changes are coalesced)
+    thread persistence_thread;
+    mutex persistence_mutex;
+    condition_variable persistence_cv;
+    bool persistence_pending = false;
+    bool persistence_stopping = false;
+    string pending_user_rows; // Registrations not yet appended to the user file
+
     // Adjacency Matrix and Constants
     AdjacencyMatrix *adjacency_matrix; // Adjacency matrix for connections
+    EdgeStore edge_store;              // Binary file persisting the connections map
+    string user_data_path;             // CSV that registrations are appended to
     const int InitialNum = 100; // Initial number of users or connections
+    const size_t MinLshCandidates = 25;  // Fall back to a full scan below this many scored candidates
+    const size_t MaxLshCandidates = 200; // Bucket mates scored per recommendation, most collisions first
+    const unsigned CommunitySeed = 20240601; // Group sizes in detectCommunities, fixed so reruns are reproducible
+
+    // Helper Functions
+    vector<string> getSimilarityTokens(User *user);
+    void invalidateNeighborhood(const string &user_id); // Drop cached recommendations within two hops of a user
+    void invalidateSimilarUsers(const string &user_id); // ... and for the users sharing an LSH bucket with it
+    void eraseRecommendations(const string &user_id);
+    void markAdjacencyDirty(const string &user_id);
+    RecommendationShard &getRecommendationShard(const string &user_id);
+    void clearRecommendations();
+    void persistGraph(); // Saves now, or hands off to the writer thread when it runs
+    void runPersistence();
+    bool appendUserRows(const string &rows);
+    void setCommunities(vector<vector<User *>> communities); // Installs communities for the current graph version
+    int getCommunityIndex(const string &user_id) const;      // In the last detected communities (no rerun), -1 if none
+    void updateLeaderboard(CachedScores &cache);              // Applies changed scores to the leaderboard
+    const unordered_map<string, double> &getCachedScores(CachedScores &cache,
+                                                         unordered_map<string, double> (ConnectionManager::*compute)());
+    vector<pair<double, User *>> rankRecommendations(User *new_user,
+                                                     const vector<LinkPredictor::LinkScore> &link_scores,
+                                                     size_t top_k,
+                                                     const unordered_map<string, unordered_set<string>> *attribute_cache) const;
 
 };
 
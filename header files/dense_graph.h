@@ -0,0 +1,43 @@
+#ifndef DENSE_GRAPH_H
+#define DENSE_GRAPH_H
+
+#include <bits/stdc++.h>
+#include "graph_snapshot.h"
+
+using namespace std;
+
+// Read-only view of a graph snapshot over dense indices (users in snapshot
+// order), with neighbors in one compressed adjacency array, so traversals
+// touch integer arrays instead of hashing user IDs at every step.
+class DenseGraph
+{
+public:
+    static constexpr uint32_t NoIndex = numeric_limits<uint32_t>::max();
+
+    // Constructor
+    explicit DenseGraph(const GraphSnapshot &graph);
+
+    // Lookups
+    unsigned long getVersion() const { return version; }
+    size_t size() const { return user_ids->size(); }
+    uint32_t getIndex(const string &user_id) const; // NoIndex if the user is not in the snapshot
+    const string &getID(uint32_t index) const { return (*user_ids)[index]; }
+    size_t degree(uint32_t index) const { return offsets[index + 1] - offsets[index]; }
+    const uint32_t *neighborsBegin(uint32_t index) const { return targets.data() + offsets[index]; }
+    const uint32_t *neighborsEnd(uint32_t index) const { return targets.data() + offsets[index + 1]; }
+
+    // Shortest Paths
+    // Bidirectional BFS: expands the smaller frontier one level at a time and
+    // stops at the level where the two searches meet. Returns the indices from
+    // source to target, empty if they are not connected.
+    vector<uint32_t> shortestPath(uint32_t source, uint32_t target) const;
+
+private:
+    unsigned long version;
+    shared_ptr<const vector<string>> user_ids; // Index -> user ID, shared with the snapshot
+    unordered_map<string, uint32_t> index_of;
+    vector<uint32_t> offsets; // Neighbors of i are targets[offsets[i] .. offsets[i + 1])
+    vector<uint32_t> targets;
+};
+
+#endif // DENSE_GRAPH_H
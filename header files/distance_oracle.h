@@ -0,0 +1,58 @@
+#ifndef DISTANCE_ORACLE_H
+#define DISTANCE_ORACLE_H
+
+#include <bits/stdc++.h>
+#include "dense_graph.h"
+
+using namespace std;
+
+// Exact hop distances by pruned landmark labeling. Users are ranked by degree
+// and a BFS from each one, in rank order, labels every vertex it reaches with
+// (rank, distance), except where the labels so far already give a distance
+// that short. A query merges the two sorted label lists, which stay small
+// because the high-degree users cover most shortest paths; the lists are kept
+// in flat arrays ending in a sentinel rank so the merge needs no bounds checks.
+//
+// Built for one DenseGraph version. Building from the previous oracle keeps its
+// labels when the graph only gained users and edges (each new edge resumes the
+// pruned BFS of the landmarks labeling its endpoints); removed edges, or more
+// than MaxIncrementalEdges new ones, mean a full rebuild.
+class DistanceOracle
+{
+public:
+    static constexpr uint32_t Unreachable = numeric_limits<uint32_t>::max();
+    static constexpr size_t MaxIncrementalEdges = 256;
+
+    // Constructors
+    explicit DistanceOracle(shared_ptr<const DenseGraph> graph);
+    DistanceOracle(shared_ptr<const DenseGraph> graph, const DistanceOracle &previous);
+
+    // Queries
+    uint32_t distance(uint32_t a, uint32_t b) const; // Dense indices of graph, Unreachable if not connected
+    const DenseGraph &getGraph() const { return *graph; }
+    unsigned long getVersion() const { return graph->getVersion(); }
+    size_t getLabelEntries() const; // Total label size, for sizing the index
+
+private:
+    struct LabelEntry
+    {
+        uint32_t rank; // Landmark, by rank
+        uint32_t distance;
+    };
+
+    shared_ptr<const DenseGraph> graph;
+    vector<uint32_t> vertex_of_rank; // Landmark order, highest degree first
+    vector<uint32_t> label_offsets;  // Label of vertex v: [label_offsets[v], label_offsets[v + 1]), sorted by rank
+    vector<uint32_t> label_ranks;    // Each label ends with rank Unreachable
+    vector<uint32_t> label_distances;
+
+    // Helper Functions
+    void build();
+    bool update(const DistanceOracle &previous); // False if a full rebuild is needed
+    void resumeSearch(vector<vector<LabelEntry>> &labels, uint32_t rank, uint32_t start, uint32_t start_distance,
+                      vector<uint32_t> &root_distance, vector<bool> &queued) const;
+    vector<vector<LabelEntry>> getLabels() const;
+    void setLabels(const vector<vector<LabelEntry>> &labels);
+};
+
+#endif // DISTANCE_ORACLE_H
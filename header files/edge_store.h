@@ -0,0 +1,28 @@
+#ifndef EDGE_STORE_H
+#define EDGE_STORE_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Compact binary file for the connection graph.
+//
+// Layout: "EDGE", format version, user ID table (length-prefixed), then for
+// every user its neighbor count and the sorted neighbor indices, delta-encoded
+// as varints. The whole file is read with one sequential read.
+class EdgeStore
+{
+public:
+    // Constructor
+    EdgeStore(const string &edge_file);
+
+    // File Operations
+    bool save(const unordered_map<string, vector<string>> &connections) const;
+    bool load(unordered_map<string, vector<string>> &connections) const; // False if missing or unreadable
+    bool exists() const;
+
+private:
+    string edge_file_path;
+};
+
+#endif // EDGE_STORE_H
@@ -0,0 +1,68 @@
+#ifndef FORCE_LAYOUT_H
+#define FORCE_LAYOUT_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// ForceAtlas2-style force-directed layout with Barnes-Hut repulsion.
+// Nodes are dense indices; forces are computed in parallel with OpenMP.
+class ForceLayout
+{
+public:
+    struct Edge
+    {
+        int from;
+        int to;
+        double weight;
+    };
+
+    struct Settings
+    {
+        double scaling = 2.0;          // Repulsion strength
+        double gravity = 1.0;          // Pull towards the origin, keeps components together
+        double theta = 1.2;            // Barnes-Hut accuracy (larger is faster and coarser)
+        double jitter_tolerance = 1.0; // How much swinging is accepted before slowing down
+        int iterations = 300;
+        unsigned seed = 42;            // Initial placement is deterministic for a given seed
+    };
+
+    // Constructor; community[i] is the community of node i (-1 for none)
+    ForceLayout(size_t num_nodes, vector<Edge> edges, const vector<int> &community, Settings settings);
+
+    // Runs all iterations and returns the final positions
+    const vector<pair<double, double>> &run();
+
+    const vector<pair<double, double>> &getPositions() const { return positions; }
+    void setMass(int node, double value) { mass[node] = value; } // Heavier nodes push others further away
+
+private:
+    // Flat Barnes-Hut quadtree; a cell is a leaf when body >= 0 or mass == 0
+    struct Cell
+    {
+        double center_x, center_y, half_size; // Square region covered by the cell
+        double mass_x = 0, mass_y = 0, mass = 0; // Center of mass (accumulated, then divided)
+        int body = -1;                         // Single body stored in a leaf
+        int children = -1;                     // Index of the first of four children
+    };
+
+    size_t num_nodes;
+    vector<Edge> edges;
+    Settings settings;
+    vector<pair<double, double>> positions;
+    vector<double> mass; // Degree + 1, as in ForceAtlas2
+    vector<pair<double, double>> forces;
+    vector<pair<double, double>> previous_forces;
+    vector<Cell> cells;
+    double speed = 1.0;
+    double speed_efficiency = 1.0;
+
+    // Helper Functions
+    void placeByCommunity(const vector<int> &community);
+    void buildQuadTree();
+    void insertBody(int body);
+    void addRepulsion(int node, double &force_x, double &force_y) const;
+    void step();
+};
+
+#endif // FORCE_LAYOUT_H
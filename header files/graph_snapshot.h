@@ -0,0 +1,26 @@
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Immutable, versioned view of the connection graph.
+// Adjacency blocks are shared between snapshots and only copied for users
+// whose neighbors changed, so readers can keep a snapshot while writers
+// publish the next one.
+struct GraphSnapshot
+{
+    unsigned long version = 0;
+    shared_ptr<const vector<string>> user_ids;                            // Users in ConnectionManager order
+    unordered_map<string, shared_ptr<const vector<string>>> adjacency;    // User ID -> neighbor block
+
+    const vector<string> &neighbors(const string &user_id) const
+    {
+        static const vector<string> empty;
+        auto it = adjacency.find(user_id);
+        return it != adjacency.end() ? *it->second : empty;
+    }
+};
+
+#endif // GRAPH_SNAPSHOT_H
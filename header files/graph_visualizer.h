@@ -2,6 +2,7 @@
 #define GRAPH_VISUALIZER_H
 
 #include <bits/stdc++.h>
+#include "force_layout.h"
 #include "user.h"
 
 using namespace std;
@@ -9,6 +10,14 @@ using namespace std;
 class GraphVisualizer
 {
 public:
+    // One undirected edge, endpoints as indices into the accompanying user ID list
+    struct Edge
+    {
+        size_t from;
+        size_t to;
+        double weight;
+    };
+
     // Constructor
     GraphVisualizer(double threshold = 15.0); // Constructor with weight threshold
 
@@ -16,17 +25,55 @@ public:
     void createGraph(const string &matrix_file,
                      const vector<vector<User *>> &communities,
                      const string &output_file);
+    void createGraph(const vector<string> &user_ids, // Renders an in-memory edge list, no CSV round trip
+                     const vector<Edge> &edges,
+                     const vector<vector<User *>> &communities,
+                     const string &output_file);
+
+    // Native rendering: ForceAtlas2 layout written straight to SVG, no external tools
+    void createSvg(const vector<string> &user_ids,
+                   const vector<Edge> &edges,
+                   const vector<vector<User *>> &communities,
+                   const string &output_file);
+
+    // Level of detail: every community becomes one supernode (sized by members, edges summed),
+    // except the expanded ones (indices into communities), which show their members
+    void createCommunityOverview(const vector<string> &user_ids,
+                                 const vector<Edge> &edges,
+                                 const vector<vector<User *>> &communities,
+                                 const unordered_set<int> &expanded_communities,
+                                 const string &output_file);
+
+    // Streams the DOT document to any output (file, pipe, stdout); each edge is listed once
+    void writeDotFormat(ostream &dot,
+                        const vector<string> &user_ids,
+                        const vector<Edge> &edges,
+                        const vector<vector<User *>> &communities);
 
 private:
     double weight_threshold; // Minimum weight for edge creation
 
+    // One drawn node of the SVG output (a user or a whole community)
+    struct SvgNode
+    {
+        string id;
+        string label;
+        int community; // -1 when the user is in no community
+        double radius;
+    };
+
     // Helper Functions for Graph Creation
-    vector<vector<double>> readAdjacencyMatrix(const string &matrix_file, 
-                                               vector<string> &user_ids);
-    string generateDotFormat(const vector<vector<double>> &matrix, 
-                              const vector<string> &user_ids, 
-                              const vector<vector<User *>> &communities);
+    bool readAdjacencyMatrix(const string &matrix_file,
+                             vector<string> &user_ids,
+                             vector<Edge> &edges); // Nonzero entries above the diagonal
+    bool renderDot(const vector<string> &user_ids,
+                   const vector<Edge> &edges,
+                   const vector<vector<User *>> &communities,
+                   const string &output_file); // Pipes DOT text straight into the renderer
     string generateEdgeStyle(double weight);
+    void layoutAndWriteSvg(const vector<SvgNode> &nodes,
+                           const vector<ForceLayout::Edge> &edges,
+                           const string &output_file);
 
     // Helper Functions for Community and Node Styling
     string getNodeColor(int community_index);
@@ -0,0 +1,35 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Ranked scores over dense user slots, kept in an indexed tournament tree
+// (every internal node holds the best slot below it). Changing one score is
+// O(log n) and reading the top k never looks at the other entries.
+class Leaderboard
+{
+public:
+    // Score Updates
+    void update(uint32_t slot, double score); // No-op when the score is unchanged
+    void remove(uint32_t slot);
+    void clear();
+
+    // Queries
+    vector<pair<uint32_t, double>> top(size_t k) const; // Highest first, ties broken by lower slot
+    size_t size() const { return count; }
+
+private:
+    size_t capacity = 0;       // Number of leaves, a power of two
+    size_t count = 0;          // Slots that currently have a score
+    vector<double> scores;     // Per slot, NaN when absent
+    vector<uint32_t> winners;  // Heap layout: node 1 is the root, leaves start at capacity
+
+    // Helper Functions
+    bool better(uint32_t a, uint32_t b) const;
+    void grow(size_t min_slots);
+    void replay(size_t leaf); // Recomputes the winners on the path from a leaf to the root
+};
+
+#endif // LEADERBOARD_H
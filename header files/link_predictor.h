@@ -0,0 +1,49 @@
+#ifndef LINK_PREDICTOR_H
+#define LINK_PREDICTOR_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Structural link prediction over the connection graph (friends-of-friends)
+class LinkPredictor
+{
+public:
+    // Scores for one candidate reached through the two-hop neighborhood
+    struct LinkScore
+    {
+        string candidate_id;
+        int common_neighbors;
+        double jaccard;
+        double adamic_adar;
+    };
+
+    // Per-thread scratch buffers, sized lazily and reset after every query
+    struct Scratch
+    {
+        vector<int> common;
+        vector<double> adamic_adar;
+        vector<int> touched;
+    };
+
+    // Constructor builds a dense, sorted adjacency index from the connection map
+    LinkPredictor(const unordered_map<string, vector<string>> &connections);
+
+    // Candidates for a single user, sorted by Adamic-Adar score (top_k = 0 keeps all)
+    vector<LinkScore> predict(const string &user_id, size_t top_k = 0) const;
+    vector<LinkScore> predict(const string &user_id, size_t top_k, Scratch &scratch) const; // Reuses buffers across calls
+
+    // Candidates for many users, computed in parallel
+    unordered_map<string, vector<LinkScore>> predictAll(const vector<string> &user_ids, size_t top_k) const;
+
+private:
+    vector<string> ids;                  // Dense index -> user ID
+    unordered_map<string, int> index;    // User ID -> dense index
+    vector<vector<int>> adjacency;       // Sorted, de-duplicated neighbor lists
+    vector<double> inverse_log_degree;   // 1 / log(degree) per node, 0 for degree < 2
+
+    // Accumulates the two-hop scores of one user into the given scratch buffers
+    vector<LinkScore> predictIndex(int user, size_t top_k, Scratch &scratch) const;
+};
+
+#endif // LINK_PREDICTOR_H
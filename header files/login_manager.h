@@ -6,6 +6,17 @@
 
 using namespace std;
 
+// Plain user fields used for bulk registration
+struct UserRecord
+{
+    string name;
+    string id;
+    string password;
+    string category;
+    double influence = 0.0;
+    string branch;
+};
+
 class LoginManager
 {
 public:
@@ -22,6 +33,12 @@ public:
     bool registerUser(const string &name, const string &id, const string &password,
                       const string &category, double influence, const string &branch);
 
+    // Registers many users at once (duplicate IDs are skipped), returns the number registered
+    int registerUsers(const vector<UserRecord> &records);
+
+    // Registers every user listed in a CSV file with the same layout as user_data.csv
+    int registerUsersFromFile(const string &file_path);
+
     // Checks if the user exists in the system
     bool isUserExist(const string &id);
 
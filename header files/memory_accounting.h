@@ -0,0 +1,70 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Live and peak heap bytes per subsystem. The global operator new/delete are
+// replaced by a tracking allocator: every block carries a small header with its
+// size and the subsystem of the innermost Scope active on the allocating thread,
+// so a block is charged to whoever allocated it, even when another thread frees it.
+// Threads batch their updates (up to PendingLimit bytes per subsystem), so
+// live totals are exact to within that much per thread.
+//
+// A diagnostic build option: the allocator is only compiled in when
+// SOCIAL_NETWORK_MEMORY_TRACKING is defined; otherwise Scope only sets a
+// thread-local tag and reports say tracking is disabled.
+class MemoryAccounting
+{
+public:
+    enum class Subsystem : uint8_t
+    {
+        Other,
+        Users,           // User store, the manager's user list and lookup
+        LoginManager,    // The login manager's own ID -> User map
+        Connections,     // Adjacency lists
+        AdjacencyMatrix, // Dense weight matrix
+        SimilarityIndex, // MinHash signatures and LSH buckets
+        Snapshots,       // Copy-on-write graph snapshots and their dense views
+        Communities,     // Detection and the cached partition
+        Betweenness,     // Per-run temporaries and results
+        Closeness,
+        PageRank,
+        DistanceOracle,  // Landmark labels for hop distances
+        AnalyticsCache,  // Leaderboards and scores loaded from analytics snapshots
+        Recommendations, // Ranking and the recommendation cache
+        Rendering,       // DOT/SVG output and layouts
+        Count
+    };
+    static constexpr int64_t PendingLimit = 8 * 1024;
+
+    // Charges allocations on this thread to a subsystem until the scope ends (scopes nest)
+    class Scope
+    {
+    public:
+        explicit Scope(Subsystem subsystem);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        uint8_t previous;
+    };
+
+    struct Usage
+    {
+        const char *name;
+        int64_t live_bytes;
+        int64_t peak_bytes;
+    };
+
+    // Reporting
+    static bool isEnabled(); // False when built without tracking
+    static vector<Usage> getUsage();
+    static string getReport(); // Table of live and peak KB per subsystem
+    static bool writeReport(const string &file_path);
+    static const char *getName(Subsystem subsystem);
+};
+
+#endif // MEMORY_ACCOUNTING_H
@@ -0,0 +1,71 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Process-wide registry of counters and latency histograms. Every thread
+// records into its own shard, so the hot path takes no lock and shares no
+// cache line; shards are summed only when the metrics are exported.
+class Metrics
+{
+public:
+    static constexpr size_t MaxCounters = 128;
+    static constexpr size_t MaxHistograms = 64;
+    static constexpr size_t NumBuckets = 24; // Upper bounds 1us, 2us, 4us ... ~8.4s, then +Inf
+
+    // Handles are cheap to copy; register once (e.g. as a file-level static) and reuse
+    class Counter
+    {
+    public:
+        void add(uint64_t value = 1) const;
+
+    private:
+        friend class Metrics;
+        explicit Counter(size_t id) : id(id) {}
+        size_t id;
+    };
+
+    class Histogram
+    {
+    public:
+        void observe(double seconds) const;
+
+    private:
+        friend class Metrics;
+        explicit Histogram(size_t id) : id(id) {}
+        size_t id;
+    };
+
+    // Observes the lifetime of the enclosing scope
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram histogram) : histogram(histogram), start(chrono::steady_clock::now()) {}
+        ~ScopedTimer() { histogram.observe(chrono::duration<double>(chrono::steady_clock::now() - start).count()); }
+
+    private:
+        Histogram histogram;
+        chrono::steady_clock::time_point start;
+    };
+
+    // Registration (Prometheus-style names; registering a name again returns the same metric)
+    static Counter counter(const string &name, const string &help);
+    static Histogram histogram(const string &name, const string &help);
+
+    // Export (aggregates every live thread and every thread that has exited)
+    static string toJson();
+    static string toPrometheus();
+    static bool writeToFile(const string &file_path); // JSON for *.json, Prometheus text otherwise
+
+private:
+    struct Shard;
+    struct Registry;
+    struct Totals;
+    static Registry &registry();
+    static Shard &localShard();
+    static Totals collect();
+};
+
+#endif // METRICS_H
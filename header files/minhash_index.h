@@ -0,0 +1,38 @@
+#ifndef MINHASH_INDEX_H
+#define MINHASH_INDEX_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Banded MinHash (LSH) index for approximate similar-user search
+class MinHashIndex
+{
+public:
+    // Constructor (num_bands * rows_per_band hash functions per signature)
+    MinHashIndex(int num_bands = 8, int rows_per_band = 4);
+
+    // Index Maintenance
+    void updateUser(const string &user_id, const vector<string> &tokens); // Recompute signature from scratch (no tokens: not indexed)
+    void addToken(const string &user_id, const string &token);            // Incremental update (e.g. new neighbor)
+    void removeUser(const string &user_id);
+    void clear();
+
+    // Candidate Retrieval
+    vector<string> query(const string &user_id, size_t max_candidates = 0) const; // Users sharing at least one band, most collisions first
+
+private:
+    int num_bands;
+    int rows_per_band;
+
+    unordered_map<string, vector<uint64_t>> signatures;                 // User ID -> MinHash signature
+    vector<unordered_map<uint64_t, unordered_set<string>>> band_buckets; // Per band: bucket key -> user IDs
+
+    // Helper Functions
+    uint64_t hashToken(const string &token, int hash_index) const;
+    uint64_t bandKey(const vector<uint64_t> &signature, int band) const;
+    void insertIntoBuckets(const string &user_id, const vector<uint64_t> &signature);
+    void removeFromBuckets(const string &user_id, const vector<uint64_t> &signature);
+};
+
+#endif // MINHASH_INDEX_H
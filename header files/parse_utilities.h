@@ -0,0 +1,16 @@
+#ifndef PARSE_UTILITIES_H
+#define PARSE_UTILITIES_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Validation of numeric arguments taken from users (command line, socket requests, replay files)
+class ParseUtilities
+{
+public:
+    // Positive decimal that fits in size_t; stoul alone would wrap "-1" and accept "5abc"
+    static bool parseCount(const string &field, size_t &count);
+};
+
+#endif // PARSE_UTILITIES_H
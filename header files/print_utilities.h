@@ -10,7 +10,6 @@ class PrintUtilities
 {
 public:
     static void printResults(ConnectionManager &cm,
-                             const  unordered_map< string, double> &pagerank,
                              const  vector< vector<User *>> &communities);
 
     static void printRecommendedCommunities(const  vector< vector<User *>> &communities,
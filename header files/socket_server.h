@@ -0,0 +1,62 @@
+#ifndef SOCKET_SERVER_H
+#define SOCKET_SERVER_H
+
+#include <bits/stdc++.h>
+#include "connection_manager.h"
+#include "login_manager.h"
+
+using namespace std;
+
+// Long-running service mode: serves requests over a Unix domain socket.
+//
+// Protocol: one request per line, fields separated by tabs (or by spaces when
+// no field contains a space). Every response is a single line starting with
+// "OK" or "ERR".
+//
+//   LOGIN <id> <password>            start a session for this client
+//   REGISTER <name> <id> <password> <category> <influence> <branch>
+//   CONNECTIONS                      connections of the session user
+//   CONNECT <id>                     connect the session user with <id>
+//   DISCONNECT <id>                  remove that connection
+//   RECOMMEND [k]                    top-k recommended user IDs (default 5)
+//   PATH <id>                        shortest chain of connections to <id>, e.g. "OK u1 u7 u42"
+//   DISTANCE <id>                    degrees of separation from <id>, e.g. "OK 2"
+//   CENTRALITY <pagerank|betweenness|closeness> [k]
+//   METRICS <file>                   write the metrics registry (JSON for *.json, else Prometheus text)
+//   MEMORY                           live/peak KB per subsystem, e.g. "OK connections=812/950 ..."
+//   QUIT                             close this client connection
+//   SHUTDOWN                         stop the server
+//
+// Sessions run concurrently: queries share the ConnectionManager read lock,
+// REGISTER/CONNECT/DISCONNECT take the write lock, and files are written by
+// the manager's background persistence thread. PATH and DISTANCE hold the
+// read lock only while fetching the published graph they search.
+class SocketServer
+{
+public:
+    // Constructor
+    SocketServer(ConnectionManager &cm, LoginManager &login_manager, const string &socket_path);
+
+    // Accepts clients until SHUTDOWN, returns false if the socket could not be opened
+    bool run();
+
+private:
+    ConnectionManager &cm;
+    LoginManager &login_manager;
+    string socket_path;
+
+    int listen_fd = -1;
+    atomic<bool> running{false};
+    mutex clients_mutex;
+    unordered_set<int> active_clients; // Shut down on exit so idle clients don't block it
+
+    // Helper Functions
+    void serveClient(int client_fd);
+    string handleRequest(const vector<string> &fields, User *&session_user, bool &close_client);
+    string handleGraphQuery(const vector<string> &fields, User *session_user); // PATH and DISTANCE, takes its own lock
+    static vector<string> splitFields(const string &line);
+    static bool isMutation(const vector<string> &fields); // Needs the manager's write lock
+    static bool isGraphQuery(const vector<string> &fields); // Handled by handleGraphQuery
+};
+
+#endif // SOCKET_SERVER_H
@@ -0,0 +1,45 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Optional timeline profiling. While a trace is running, every Span records
+// a complete event on its thread; stop() writes them all as Chrome
+// trace-event JSON (open it in chrome://tracing or ui.perfetto.dev).
+// When no trace is running a Span costs one atomic load.
+class Trace
+{
+public:
+    // Marks a phase for the lifetime of the enclosing scope; name and category must outlive the trace
+    class Span
+    {
+    public:
+        explicit Span(const char *name, const char *category = "app");
+        ~Span();
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *name;
+        const char *category;
+        int64_t start_ns = -1; // -1 when the trace was off at construction
+    };
+
+    static void start(const string &file_path);
+    static bool stop(); // Writes the trace file, false if there was no trace or it could not be written
+    static bool isEnabled() { return enabled.load(memory_order_acquire); }
+    static void setThreadName(const string &name); // Row label for the calling thread, ignored without a trace
+
+private:
+    struct Event;
+    struct ThreadBuffer;
+    struct Registry;
+    static atomic<bool> enabled;
+    static Registry &registry();
+    static ThreadBuffer &localBuffer();
+    static int64_t now();
+};
+
+#endif // TRACE_H
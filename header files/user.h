@@ -2,34 +2,36 @@
 #define USER_H
 
 #include <string>
+#include <string_view>
+#include "user_store.h"
 
 using namespace std;
 
+// Lightweight handle to a user's row in the UserStore
 class User
 {
 public:
-    // Constructor to initialize user attributes
-    User(const string &name, const string &id, const string &password,
-         const string &category, double influence, const string &branch)
-         : name(name), id(id), password(password), category(category),
-           influence(influence), branch(branch) {}
-
-    // Getter methods for user attributes
-    string getName() const { return name; }
-    string getID() const { return id; }
-    string getPassword() const { return password; }
-    string getCategory() const { return category; }
-    double getInfluence() const { return influence; }
-    string getBranch() const { return branch; }
+    // Constructor (only UserStore creates handles)
+    User(const UserStore *store, uint32_t slot) : store(store), slot(slot) {}
+
+    // Getter methods for user attributes (views into the store, no copies)
+    string_view getName() const { return store->getName(slot); }
+    const string &getID() const { return store->getID(slot); }
+    string_view getPassword() const { return store->getPassword(slot); }
+    string_view getCategory() const { return store->getCategory(slot); }
+    double getInfluence() const { return store->getInfluence(slot); }
+    string_view getBranch() const { return store->getBranch(slot); }
+
+    // Dictionary codes, compare these instead of the strings
+    uint32_t getCategoryCode() const { return store->getCategoryCode(slot); }
+    uint32_t getBranchCode() const { return store->getBranchCode(slot); }
+
+    // Dense slot id, usable as an array index
+    uint32_t getSlot() const { return slot; }
 
 private:
-    // User attributes
-    string name;
-    string id;
-    string password;
-    string category;
-    double influence;
-    string branch;
+    const UserStore *store;
+    uint32_t slot;
 };
 
 #endif // USER_H
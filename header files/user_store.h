@@ -0,0 +1,80 @@
+#ifndef USER_STORE_H
+#define USER_STORE_H
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+class User;
+
+// Interns repeated attribute values (category, branch) into small integer codes
+class AttributeDictionary
+{
+public:
+    static const uint32_t NotFound = numeric_limits<uint32_t>::max();
+
+    uint32_t findCode(string_view value) const; // NotFound if the value was never seen
+    string_view getValue(uint32_t code) const { return values[code]; }
+    size_t size() const { return values.size(); }
+
+private:
+    friend class UserStore;
+    vector<string_view> values;                // Code -> value (views into the store arena)
+    unordered_map<string_view, uint32_t> codes; // Value -> code
+};
+
+// Columnar storage for all user attributes; User objects are lightweight handles into it
+class UserStore
+{
+public:
+    // Constructor and Destructor
+    UserStore();
+    ~UserStore();
+
+    UserStore(const UserStore &) = delete;
+    UserStore &operator=(const UserStore &) = delete;
+
+    // Adds a user and returns its handle (stable for the lifetime of the store)
+    User *addUser(const string &name, const string &id, const string &password,
+                  const string &category, double influence, const string &branch);
+
+    // Zero-copy column accessors by dense slot id
+    string_view getName(uint32_t slot) const { return names[slot]; }
+    const string &getID(uint32_t slot) const { return ids[slot]; }
+    string_view getPassword(uint32_t slot) const { return passwords[slot]; }
+    string_view getCategory(uint32_t slot) const { return category_dictionary.getValue(category_codes[slot]); }
+    double getInfluence(uint32_t slot) const { return influences[slot]; }
+    string_view getBranch(uint32_t slot) const { return branch_dictionary.getValue(branch_codes[slot]); }
+
+    // Dictionary-encoded attributes: equal values share a code
+    uint32_t getCategoryCode(uint32_t slot) const { return category_codes[slot]; }
+    uint32_t getBranchCode(uint32_t slot) const { return branch_codes[slot]; }
+    const AttributeDictionary &getCategoryDictionary() const { return category_dictionary; }
+    const AttributeDictionary &getBranchDictionary() const { return branch_dictionary; }
+
+    User *getUser(uint32_t slot) const { return handles[slot].get(); }
+    size_t size() const { return ids.size(); }
+
+private:
+    // Columns (indexed by slot)
+    vector<string_view> names;
+    vector<string> ids; // Kept as strings since every map in the tree is keyed by ID
+    vector<string_view> passwords;
+    vector<uint32_t> category_codes;
+    vector<double> influences;
+    vector<uint32_t> branch_codes;
+    vector<unique_ptr<User>> handles;
+
+    AttributeDictionary category_dictionary;
+    AttributeDictionary branch_dictionary;
+
+    // String arena: fixed-size blocks so views never move
+    static const size_t ArenaBlockSize = 64 * 1024;
+    vector<unique_ptr<char[]>> arena_blocks;
+    size_t arena_used = ArenaBlockSize; // Forces a block on first use
+
+    string_view storeString(const string &value);
+    uint32_t intern(AttributeDictionary &dictionary, const string &value);
+};
+
+#endif // USER_STORE_H